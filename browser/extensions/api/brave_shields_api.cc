@@ -8,18 +8,21 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "base/bind.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/task_runner_util.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/browser/extensions/api/brave_action_api.h"
 #include "brave/browser/webcompat_reporter/webcompat_reporter_dialog.h"
 #include "brave/common/extensions/api/brave_shields.h"
 #include "brave/common/extensions/extension_constants.h"
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
-#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/components/brave_shields/browser/brave_shields_p3a.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
@@ -46,6 +49,64 @@ namespace {
 const char kInvalidUrlError[] = "Invalid URL.";
 const char kInvalidControlTypeError[] = "Invalid ControlType.";
 
+base::Value ToListValue(const std::vector<std::string>& strings) {
+  base::Value list(base::Value::Type::LIST);
+  for (const auto& item : strings) {
+    list.Append(item);
+  }
+  return list;
+}
+
+// Queries and merges the default, regional and custom engines. Runs on the
+// ad block task runner so that neither the engine output parsing nor the
+// merge happen on the UI thread.
+base::Optional<base::Value> GetUrlCosmeticResourcesOnTaskRunner(
+    const std::string& url) {
+  base::Optional<::brave_shields::CosmeticResources> resources =
+      g_brave_browser_process->ad_block_service()->UrlCosmeticResources(url);
+  if (!resources) {
+    return base::nullopt;
+  }
+
+  base::Optional<::brave_shields::CosmeticResources> regional_resources =
+      g_brave_browser_process->ad_block_regional_service_manager()->
+          UrlCosmeticResources(url);
+  if (regional_resources) {
+    resources->MergeFrom(std::move(*regional_resources), false);
+  }
+
+  base::Optional<::brave_shields::CosmeticResources> custom_resources =
+      g_brave_browser_process->ad_block_custom_filters_service()->
+          UrlCosmeticResources(url);
+  if (custom_resources) {
+    resources->MergeFrom(std::move(*custom_resources), true);
+  }
+
+  return resources->ToValue();
+}
+
+std::unique_ptr<base::ListValue> GetHiddenClassIdSelectorsOnTaskRunner(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
+  std::vector<std::string> hide_selectors =
+      g_brave_browser_process->ad_block_service()->HiddenClassIdSelectors(
+          classes, ids, exceptions);
+  ::brave_shields::MergeCosmeticSelectors(
+      &hide_selectors,
+      g_brave_browser_process->ad_block_regional_service_manager()->
+          HiddenClassIdSelectors(classes, ids, exceptions));
+
+  std::vector<std::string> custom_selectors =
+      g_brave_browser_process->ad_block_custom_filters_service()->
+          HiddenClassIdSelectors(classes, ids, exceptions);
+
+  auto result_list = std::make_unique<base::ListValue>();
+  result_list->Append(ToListValue(hide_selectors));
+  result_list->Append(ToListValue(custom_selectors));
+  return result_list;
+}
+
 }  // namespace
 
 
@@ -55,41 +116,26 @@ BraveShieldsUrlCosmeticResourcesFunction::Run() {
       brave_shields::UrlCosmeticResources::Params::Create(*args_));
   EXTENSION_FUNCTION_VALIDATE(params.get());
 
-  base::Optional<base::Value> resources = g_brave_browser_process->
-      ad_block_service()->UrlCosmeticResources(params->url);
-
-  if (!resources || !resources->is_dict()) {
-    return RespondNow(Error(
-        "Url-specific cosmetic resources could not be returned"));
-  }
-
-  base::Optional<base::Value> regional_resources = g_brave_browser_process->
-      ad_block_regional_service_manager()->
-          UrlCosmeticResources(params->url);
-
-  if (regional_resources && regional_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-            &*resources,
-            &*regional_resources,
-            false);
-  }
-
-  base::Optional<base::Value> custom_resources = g_brave_browser_process->
-      ad_block_custom_filters_service()->
-          UrlCosmeticResources(params->url);
+  base::PostTaskAndReplyWithResult(
+      g_brave_browser_process->ad_block_service()->GetTaskRunner().get(),
+      FROM_HERE,
+      base::BindOnce(&GetUrlCosmeticResourcesOnTaskRunner, params->url),
+      base::BindOnce(
+          &BraveShieldsUrlCosmeticResourcesFunction::OnUrlCosmeticResources,
+          this));
+  return RespondLater();
+}
 
-  if (custom_resources && custom_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-            &*resources,
-            &*custom_resources,
-            true);
+void BraveShieldsUrlCosmeticResourcesFunction::OnUrlCosmeticResources(
+    base::Optional<base::Value> resources) {
+  if (!resources) {
+    Respond(Error("Url-specific cosmetic resources could not be returned"));
+    return;
   }
 
   auto result_list = std::make_unique<base::ListValue>();
-
   result_list->Append(std::move(*resources));
-
-  return RespondNow(ArgumentList(std::move(result_list)));
+  Respond(ArgumentList(std::move(result_list)));
 }
 
 ExtensionFunction::ResponseAction
@@ -98,41 +144,21 @@ BraveShieldsHiddenClassIdSelectorsFunction::Run() {
       brave_shields::HiddenClassIdSelectors::Params::Create(*args_));
   EXTENSION_FUNCTION_VALIDATE(params.get());
 
-  base::Optional<base::Value> hide_selectors = g_brave_browser_process->
-      ad_block_service()->HiddenClassIdSelectors(params->classes,
-                                                 params->ids,
-                                                 params->exceptions);
-
-  base::Optional<base::Value> regional_selectors = g_brave_browser_process->
-      ad_block_regional_service_manager()->
-        HiddenClassIdSelectors(params->classes,
-                               params->ids,
-                               params->exceptions);
-
-  if (hide_selectors && hide_selectors->is_list()) {
-    if (regional_selectors && regional_selectors->is_list()) {
-      for (auto i = regional_selectors->GetList().begin();
-              i < regional_selectors->GetList().end();
-              i++) {
-        hide_selectors->Append(std::move(*i));
-      }
-    }
-  } else {
-    hide_selectors = std::move(regional_selectors);
-  }
-
-  base::Optional<base::Value> custom_selectors = g_brave_browser_process->
-      ad_block_custom_filters_service()->
-          HiddenClassIdSelectors(params->classes,
-                                 params->ids,
-                                 params->exceptions);
-
-  auto result_list = std::make_unique<base::ListValue>();
-
-  result_list->Append(std::move(*hide_selectors));
-  result_list->Append(std::move(*custom_selectors));
+  base::PostTaskAndReplyWithResult(
+      g_brave_browser_process->ad_block_service()->GetTaskRunner().get(),
+      FROM_HERE,
+      base::BindOnce(&GetHiddenClassIdSelectorsOnTaskRunner,
+                     std::move(params->classes), std::move(params->ids),
+                     std::move(params->exceptions)),
+      base::BindOnce(
+          &BraveShieldsHiddenClassIdSelectorsFunction::OnHiddenClassIdSelectors,
+          this));
+  return RespondLater();
+}
 
-  return RespondNow(ArgumentList(std::move(result_list)));
+void BraveShieldsHiddenClassIdSelectorsFunction::OnHiddenClassIdSelectors(
+    std::unique_ptr<base::ListValue> selectors) {
+  Respond(ArgumentList(std::move(selectors)));
 }
 
 
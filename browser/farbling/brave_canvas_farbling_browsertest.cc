@@ -0,0 +1,190 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "base/path_service.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "brave/browser/brave_content_browser_client.h"
+#include "brave/common/brave_paths.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/browser/ui/browser.h"
+#include "chrome/common/chrome_content_client.h"
+#include "chrome/test/base/in_process_browser_test.h"
+#include "chrome/test/base/ui_test_utils.h"
+#include "content/public/test/browser_test.h"
+#include "content/public/test/browser_test_utils.h"
+#include "net/dns/mock_host_resolver.h"
+#include "testing/perf/perf_result_reporter.h"
+
+using brave_shields::ControlType;
+
+const char kEmbeddedTestServerDirectory[] = "canvas";
+const char kTitleScript[] = "domAutomationController.send(document.title);";
+const char kDataURLScript[] =
+    "domAutomationController.send(canvas.toDataURL());";
+
+const char kMetricPrefixFarbling[] = "Farbling.";
+const char kMetricCanvasReadTime[] = "canvas_read_time";
+const char kMetricAudioReadTime[] = "audio_read_time";
+const char kMetricAnalyserReadTime[] = "analyser_read_time";
+const char kMetricWebGLReadTime[] = "webgl_read_time";
+const char kMetricWebGLStringTime[] = "webgl_string_time";
+// Reads per script run, so that the IPC round trip is spread over many reads
+const int kReadsPerLap = 20;
+
+class BraveCanvasFarblingBrowserTest : public InProcessBrowserTest {
+ public:
+  void SetUpOnMainThread() override {
+    InProcessBrowserTest::SetUpOnMainThread();
+
+    content_client_.reset(new ChromeContentClient);
+    content::SetContentClient(content_client_.get());
+    browser_content_client_.reset(new BraveContentBrowserClient());
+    content::SetBrowserClientForTesting(browser_content_client_.get());
+
+    host_resolver()->AddRule("*", "127.0.0.1");
+    content::SetupCrossSiteRedirector(embedded_test_server());
+
+    brave::RegisterPathProvider();
+    base::FilePath test_data_dir;
+    base::PathService::Get(brave::DIR_TEST_DATA, &test_data_dir);
+    test_data_dir = test_data_dir.AppendASCII(kEmbeddedTestServerDirectory);
+    embedded_test_server()->ServeFilesFromDirectory(test_data_dir);
+
+    ASSERT_TRUE(embedded_test_server()->Start());
+
+    top_level_page_url_ = embedded_test_server()->GetURL("a.com", "/");
+    farbling_url_ = embedded_test_server()->GetURL("a.com", "/farbling.html");
+    farbling_perf_url_ =
+        embedded_test_server()->GetURL("a.com", "/farbling_perf.html");
+  }
+
+  void TearDown() override {
+    browser_content_client_.reset();
+    content_client_.reset();
+  }
+
+  const GURL& farbling_url() { return farbling_url_; }
+  const GURL& farbling_perf_url() { return farbling_perf_url_; }
+
+  HostContentSettingsMap* content_settings() {
+    return HostContentSettingsMapFactory::GetForProfile(browser()->profile());
+  }
+
+  void AllowFingerprinting() {
+    brave_shields::SetFingerprintingControlType(
+        content_settings(), ControlType::ALLOW, top_level_page_url_);
+  }
+
+  void BlockFingerprinting() {
+    brave_shields::SetFingerprintingControlType(
+        content_settings(), ControlType::BLOCK, top_level_page_url_);
+  }
+
+  void SetFingerprintingDefault() {
+    brave_shields::SetFingerprintingControlType(
+        content_settings(), ControlType::DEFAULT, top_level_page_url_);
+  }
+
+  template <typename T>
+  std::string ExecScriptGetStr(const std::string& script, T* frame) {
+    std::string value;
+    EXPECT_TRUE(ExecuteScriptAndExtractString(frame, script, &value));
+    return value;
+  }
+
+  content::WebContents* contents() {
+    return browser()->tab_strip_model()->GetActiveWebContents();
+  }
+
+  bool NavigateToURLUntilLoadStop(const GURL& url) {
+    ui_test_utils::NavigateToURL(browser(), url);
+    return WaitForLoadStop(contents());
+  }
+
+  // Loads the farbling page and returns the canvas as a data URL, after
+  // checking that repeated reads of the unchanged canvas agree.
+  std::string LoadAndReadCanvas() {
+    NavigateToURLUntilLoadStop(farbling_url());
+    EXPECT_EQ(ExecScriptGetStr(kTitleScript, contents()), "consistent");
+    return ExecScriptGetStr(kDataURLScript, contents());
+  }
+
+  // Times |function| of the perf page, which does kReadsPerLap reads, and
+  // reports the time of a single read.
+  void MeasureReads(const std::string& function,
+                    const std::string& metric,
+                    const perf_test::PerfResultReporter& reporter) {
+    const std::string script =
+        base::StringPrintf("%s(%d);", function.c_str(), kReadsPerLap);
+    base::LapTimer timer(2, base::TimeDelta::FromSeconds(1), 1);
+    do {
+      ASSERT_TRUE(content::ExecuteScript(contents(), script));
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+    reporter.AddResult(metric, timer.TimePerLap() / kReadsPerLap);
+  }
+
+  void MeasureFarbling(const std::string& story) {
+    perf_test::PerfResultReporter reporter(kMetricPrefixFarbling, story);
+    reporter.RegisterImportantMetric(kMetricCanvasReadTime, "ms");
+    reporter.RegisterImportantMetric(kMetricAudioReadTime, "ms");
+    reporter.RegisterImportantMetric(kMetricAnalyserReadTime, "ms");
+    reporter.RegisterImportantMetric(kMetricWebGLReadTime, "ms");
+    reporter.RegisterImportantMetric(kMetricWebGLStringTime, "ms");
+
+    NavigateToURLUntilLoadStop(farbling_perf_url());
+    MeasureReads("readCanvas", kMetricCanvasReadTime, reporter);
+    MeasureReads("readAudio", kMetricAudioReadTime, reporter);
+    MeasureReads("readAnalyser", kMetricAnalyserReadTime, reporter);
+    MeasureReads("readWebGL", kMetricWebGLReadTime, reporter);
+    MeasureReads("readWebGLStrings", kMetricWebGLStringTime, reporter);
+  }
+
+ private:
+  GURL top_level_page_url_;
+  GURL farbling_url_;
+  GURL farbling_perf_url_;
+  std::unique_ptr<ChromeContentClient> content_client_;
+  std::unique_ptr<BraveContentBrowserClient> browser_content_client_;
+};
+
+IN_PROC_BROWSER_TEST_F(BraveCanvasFarblingBrowserTest, FarbleCanvas) {
+  // Farbling level: off
+  // canvas: original image data
+  AllowFingerprinting();
+  const std::string original = LoadAndReadCanvas();
+
+  // Farbling level: balanced (default)
+  // canvas: a few bits flipped, the same for every read in this session
+  SetFingerprintingDefault();
+  const std::string balanced = LoadAndReadCanvas();
+  EXPECT_NE(original, balanced);
+  EXPECT_EQ(balanced, LoadAndReadCanvas());
+
+  // Farbling level: maximum
+  // canvas: pseudo-random data with no relation to the original image
+  BlockFingerprinting();
+  const std::string maximum = LoadAndReadCanvas();
+  EXPECT_NE(original, maximum);
+  EXPECT_NE(balanced, maximum);
+  EXPECT_EQ(maximum, LoadAndReadCanvas());
+}
+
+// Time of each farbled read-back at each farbling level. OFF is the upstream
+// cost, so the other levels show what farbling adds. Timing only, so it runs
+// with --run-manual.
+IN_PROC_BROWSER_TEST_F(BraveCanvasFarblingBrowserTest, MANUAL_FarblingPerf) {
+  AllowFingerprinting();
+  MeasureFarbling("off");
+
+  SetFingerprintingDefault();
+  MeasureFarbling("balanced");
+
+  BlockFingerprinting();
+  MeasureFarbling("maximum");
+}
@@ -7,20 +7,27 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/base64url.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_util.h"
+#include "base/task/post_task.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/shield_exceptions.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/grit/brave_generated_resources.h"
+#include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 #include "extensions/common/url_pattern.h"
 #include "ui/base/resource/resource_bundle.h"
@@ -28,24 +35,23 @@
 namespace brave {
 
 void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx) {
+  // Computed once and shared by the default, regional and custom engines.
+  const brave_shields::AdBlockRequest request(
+      ctx->request_url, ctx->resource_type, ctx->tab_origin.host());
   bool did_match_exception = false;
-  std::string tab_host = ctx->tab_origin.host();
   if (!g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-          ctx->request_url, ctx->resource_type, tab_host,
-          &did_match_exception, &ctx->cancel_request_explicitly,
+          request, &did_match_exception, &ctx->cancel_request_explicitly,
           &ctx->mock_data_url)) {
     ctx->blocked_by = kAdBlocked;
   } else if (!did_match_exception &&
              !g_brave_browser_process->ad_block_regional_service_manager()
-                  ->ShouldStartRequest(ctx->request_url, ctx->resource_type,
-                                       tab_host, &did_match_exception,
+                  ->ShouldStartRequest(request, &did_match_exception,
                                        &ctx->cancel_request_explicitly,
                                        &ctx->mock_data_url)) {
     ctx->blocked_by = kAdBlocked;
   } else if (!did_match_exception &&
              !g_brave_browser_process->ad_block_custom_filters_service()
-                  ->ShouldStartRequest(ctx->request_url, ctx->resource_type,
-                                       tab_host, &did_match_exception,
+                  ->ShouldStartRequest(request, &did_match_exception,
                                        &ctx->cancel_request_explicitly,
                                        &ctx->mock_data_url)) {
     ctx->blocked_by = kAdBlocked;
@@ -64,6 +70,71 @@ void OnShouldBlockAdResult(const ResponseCallback& next_callback,
   next_callback.Run();
 }
 
+namespace {
+
+// Requests which reached the ad-block check during the current UI task. They
+// are sent to the ad-block task runner together so that a page issuing many
+// subresource requests at once costs one round trip instead of one per
+// request.
+using PendingAdBlockRequest =
+    std::pair<ResponseCallback, std::shared_ptr<BraveRequestInfo>>;
+using PendingAdBlockRequests = std::vector<PendingAdBlockRequest>;
+
+PendingAdBlockRequests* GetPendingAdBlockRequests() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  static base::NoDestructor<PendingAdBlockRequests> pending_requests;
+  return pending_requests.get();
+}
+
+void ShouldBlockAdsOnTaskRunner(
+    std::vector<std::shared_ptr<BraveRequestInfo>> ctxs) {
+  for (const auto& ctx : ctxs)
+    ShouldBlockAdOnTaskRunner(ctx);
+}
+
+void OnShouldBlockAdsResult(uint64_t cache_generation,
+                            PendingAdBlockRequests requests) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto* decision_cache = brave_shields::AdBlockDecisionCache::GetInstance();
+  // Replies are run in the order the requests arrived.
+  for (const auto& request : requests) {
+    const std::shared_ptr<BraveRequestInfo>& ctx = request.second;
+    brave_shields::AdBlockDecisionCache::Decision decision;
+    decision.blocked = ctx->blocked_by == kAdBlocked;
+    decision.cancel_request_explicitly = ctx->cancel_request_explicitly;
+    decision.mock_data_url = ctx->mock_data_url;
+    decision_cache->Put(ctx->request_url.spec(), ctx->tab_origin.host(),
+                        ctx->resource_type, cache_generation, decision);
+    OnShouldBlockAdResult(request.first, ctx);
+  }
+}
+
+void FlushPendingAdBlockRequests() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  PendingAdBlockRequests requests;
+  requests.swap(*GetPendingAdBlockRequests());
+  if (requests.empty())
+    return;
+
+  std::vector<std::shared_ptr<BraveRequestInfo>> ctxs;
+  ctxs.reserve(requests.size());
+  for (const auto& request : requests)
+    ctxs.push_back(request.second);
+
+  // Read before the engines are consulted, so that decisions made while an
+  // engine is being replaced are not cached.
+  const uint64_t cache_generation =
+      brave_shields::AdBlockDecisionCache::GetInstance()->generation();
+  g_brave_browser_process->ad_block_service()->GetTaskRunner()
+      ->PostTaskAndReply(
+          FROM_HERE,
+          base::BindOnce(&ShouldBlockAdsOnTaskRunner, std::move(ctxs)),
+          base::BindOnce(&OnShouldBlockAdsResult, cache_generation,
+                         std::move(requests)));
+}
+
+}  // namespace
+
 void OnBeforeURLRequestAdBlockTP(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx) {
@@ -76,11 +147,13 @@ void OnBeforeURLRequestAdBlockTP(
   }
   DCHECK_NE(ctx->request_identifier, 0UL);
 
-  g_brave_browser_process->ad_block_service()->GetTaskRunner()
-      ->PostTaskAndReply(FROM_HERE,
-                         base::BindOnce(&ShouldBlockAdOnTaskRunner, ctx),
-                         base::BindOnce(&OnShouldBlockAdResult, next_callback,
-                                        ctx));
+  PendingAdBlockRequests* pending_requests = GetPendingAdBlockRequests();
+  if (pending_requests->empty()) {
+    // Flush once the current UI task, and any requests it starts, is done.
+    base::PostTask(FROM_HERE, {content::BrowserThread::UI},
+                   base::BindOnce(&FlushPendingAdBlockRequests));
+  }
+  pending_requests->emplace_back(next_callback, std::move(ctx));
 }
 
 int OnBeforeURLRequest_AdBlockTPPreWork(
@@ -108,6 +181,22 @@ int OnBeforeURLRequest_AdBlockTPPreWork(
     return net::OK;
   }
 
+  // Answer synchronously if the same request was decided recently.
+  brave_shields::AdBlockDecisionCache::Decision decision;
+  if (brave_shields::AdBlockDecisionCache::GetInstance()->Get(
+          ctx->request_url.spec(), ctx->tab_origin.host(), ctx->resource_type,
+          &decision)) {
+    if (decision.blocked) {
+      ctx->blocked_by = kAdBlocked;
+      ctx->cancel_request_explicitly = decision.cancel_request_explicitly;
+      ctx->mock_data_url = decision.mock_data_url;
+      brave_shields::DispatchBlockedEvent(
+          ctx->request_url, ctx->render_frame_id, ctx->render_process_id,
+          ctx->frame_tree_node_id, brave_shields::kAds);
+    }
+    return net::OK;
+  }
+
   OnBeforeURLRequestAdBlockTP(next_callback, ctx);
 
   return net::ERR_IO_PENDING;
@@ -7,13 +7,18 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/command_line.h"
 #include "base/feature_list.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/optional.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "brave/common/network_constants.h"
+#include "brave/common/url_pattern_host_index.h"
 #include "brave/components/brave_component_updater/browser/features.h"
 #include "brave/components/brave_component_updater/browser/switches.h"
 #include "components/component_updater/component_updater_url_constants.h"
@@ -46,26 +51,74 @@ std::string GetUpdateURLHost() {
   return UPDATER_DEV_ENDPOINT;
 }
 
-// Update server checks happen from the profile context for admin policy
-// installed extensions. Update server checks happen from the system context for
-// normal update operations.
-bool IsUpdaterURL(const GURL& gurl) {
-  static std::vector<URLPattern> updater_patterns(
-      {URLPattern(URLPattern::SCHEME_HTTPS,
-                  std::string(component_updater::kUpdaterJSONDefaultUrl) + "*"),
-       URLPattern(
-           URLPattern::SCHEME_HTTP,
-           std::string(component_updater::kUpdaterJSONFallbackUrl) + "*"),
+enum class StaticRedirect {
+  kUpdater,
+  kChromeCast,
+  kClients4,
+  kBugReport,
+};
+
+// All patterns handled by OnBeforeURLRequest_CommonStaticRedirectWorkForGURL,
+// in priority order, grouped by host.
+class StaticRedirectTable {
+ public:
+  StaticRedirectTable()
+      : index_(BuildPatterns(&redirects_)) {}
+
+  base::Optional<StaticRedirect> Find(const GURL& url) const {
+    base::Optional<size_t> match = index_.FindMatch(url);
+    if (!match) {
+      return base::nullopt;
+    }
+    return redirects_[*match];
+  }
+
+ private:
+  static std::vector<URLPattern> BuildPatterns(
+      std::vector<StaticRedirect>* redirects) {
+    std::vector<URLPattern> patterns;
+    auto add = [&](StaticRedirect redirect, URLPattern pattern) {
+      patterns.push_back(std::move(pattern));
+      redirects->push_back(redirect);
+    };
+
+    // Update server checks happen from the profile context for admin policy
+    // installed extensions. Update server checks happen from the system
+    // context for normal update operations.
+    add(StaticRedirect::kUpdater,
+        URLPattern(
+            URLPattern::SCHEME_HTTPS,
+            std::string(component_updater::kUpdaterJSONDefaultUrl) + "*"));
+    add(StaticRedirect::kUpdater,
+        URLPattern(
+            URLPattern::SCHEME_HTTP,
+            std::string(component_updater::kUpdaterJSONFallbackUrl) + "*"));
 #if BUILDFLAG(ENABLE_EXTENSIONS)
-       URLPattern(
-           URLPattern::SCHEME_HTTPS,
-           std::string(extension_urls::kChromeWebstoreUpdateURL) + "*")
+    add(StaticRedirect::kUpdater,
+        URLPattern(
+            URLPattern::SCHEME_HTTPS,
+            std::string(extension_urls::kChromeWebstoreUpdateURL) + "*"));
 #endif
-  });
-  return std::any_of(
-      updater_patterns.begin(), updater_patterns.end(),
-      [&gurl](URLPattern pattern) { return pattern.MatchesURL(gurl); });
-}
+
+    add(StaticRedirect::kChromeCast,
+        URLPattern(URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
+                   kChromeCastPrefix));
+    // Only the host of clients4 requests matters.
+    add(StaticRedirect::kClients4,
+        URLPattern(URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
+                   std::string(kClients4Prefix) + "*"));
+    add(StaticRedirect::kBugReport,
+        URLPattern(URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
+                   "*://bugs.chromium.org/p/chromium/issues/entry?*"));
+    return patterns;
+  }
+
+  // Declared before |index_|, which is built along with it.
+  std::vector<StaticRedirect> redirects_;
+  const URLPatternHostIndex index_;
+
+  DISALLOW_COPY_AND_ASSIGN(StaticRedirectTable);
+};
 
 bool RewriteBugReportingURL(const GURL& request_url, GURL* new_url) {
   GURL url("https://github.com/brave/brave-browser/issues/new");
@@ -114,41 +167,35 @@ int OnBeforeURLRequest_CommonStaticRedirectWorkForGURL(
     GURL* new_url) {
   DCHECK(new_url);
 
-  GURL::Replacements replacements;
-  static URLPattern chromecast_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kChromeCastPrefix);
-  static URLPattern clients4_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kClients4Prefix);
-  static URLPattern bugsChromium_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
-      "*://bugs.chromium.org/p/chromium/issues/entry?*");
-
-  if (IsUpdaterURL(request_url)) {
-    auto update_host = GetUpdateURLHost();
-    if (!update_host.empty()) {
-      replacements.SetQueryStr(request_url.query_piece());
-      *new_url = GURL(update_host).ReplaceComponents(replacements);
-    }
-    return net::OK;
-  }
-
-  if (chromecast_pattern.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveRedirectorProxy);
-    *new_url = request_url.ReplaceComponents(replacements);
+  static const base::NoDestructor<StaticRedirectTable> redirect_table;
+  base::Optional<StaticRedirect> redirect = redirect_table->Find(request_url);
+  if (!redirect) {
     return net::OK;
   }
 
-  if (clients4_pattern.MatchesHost(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveClients4Proxy);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (bugsChromium_pattern.MatchesURL(request_url)) {
-    if (RewriteBugReportingURL(request_url, new_url))
-      return net::OK;
+  GURL::Replacements replacements;
+  switch (*redirect) {
+    case StaticRedirect::kUpdater: {
+      auto update_host = GetUpdateURLHost();
+      if (!update_host.empty()) {
+        replacements.SetQueryStr(request_url.query_piece());
+        *new_url = GURL(update_host).ReplaceComponents(replacements);
+      }
+      break;
+    }
+    case StaticRedirect::kChromeCast:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr(kBraveRedirectorProxy);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
+    case StaticRedirect::kClients4:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr(kBraveClients4Proxy);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
+    case StaticRedirect::kBugReport:
+      RewriteBugReportingURL(request_url, new_url);
+      break;
   }
 
   return net::OK;
@@ -0,0 +1,100 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_common_static_redirect_network_delegate_helper.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "components/component_updater/component_updater_url_constants.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_unit_tests \
+//     --filter=BraveCommonStaticRedirectNetworkDelegateHelperPerfTest.* \
+//     --run-manual
+
+namespace {
+
+const char kMetricPrefixStaticRedirect[] = "StaticRedirect.";
+const char kMetricPassThroughTime[] = "pass_through_time";
+const char kMetricRedirectTime[] = "redirect_time";
+
+// Requests of an ordinary page load, none of which is redirected
+const char* const kPageHosts[] = {
+    "www.google.com", "fonts.googleapis.com", "www.gstatic.com",
+    "securepubads.g.doubleclick.net", "connect.facebook.net",
+    "pbs.twimg.com", "i.ytimg.com", "d1.cloudfront.net",
+    "cdn.jsdelivr.net", "en.wikipedia.org", "www.nytimes.com",
+    "brave.com", "clients2.google.com", "update.googleapis.com",
+};
+const char* const kPagePaths[] = {
+    "/", "/index.html", "/static/app.js", "/images/logo.png",
+    "/api/v1/items?id=42", "/css?family=Roboto",
+};
+
+std::vector<GURL> CreatePassThroughCorpus() {
+  std::vector<GURL> corpus;
+  for (const char* host : kPageHosts) {
+    for (const char* path : kPagePaths) {
+      corpus.emplace_back(base::StringPrintf("https://%s%s", host, path));
+    }
+  }
+  return corpus;
+}
+
+// One request for every rule of the table
+std::vector<GURL> CreateRedirectCorpus() {
+  return {
+      GURL(std::string(component_updater::kUpdaterJSONDefaultUrl) +
+           "?foo=bar"),
+      GURL("https://redirector.gvt1.com/edgedl/chromewebstore/"
+           "7.5.0_pkedcjkdefgpdelpbcmbmeomcjbeemfm.crx"),
+      GURL("https://clients4.google.com/chrome-sync/dev"),
+      GURL("https://bugs.chromium.org/p/chromium/issues/entry?"
+           "comment=a&template=b&labels=c"),
+  };
+}
+
+// Reports the time of one lookup, checking whether each URL is redirected.
+void MeasureLookups(const std::string& metric,
+                    const std::vector<GURL>& corpus,
+                    const bool redirected,
+                    perf_test::PerfResultReporter* reporter) {
+  base::LapTimer timer;
+  do {
+    for (const GURL& url : corpus) {
+      GURL new_url;
+      brave::OnBeforeURLRequest_CommonStaticRedirectWorkForGURL(url, &new_url);
+      ASSERT_EQ(!new_url.is_empty(), redirected) << url.spec();
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  reporter->AddResult(metric, timer.TimePerLap() / corpus.size());
+}
+
+}  // namespace
+
+// Cost the static redirect rules add to every request, and to the requests
+// they rewrite.
+TEST(BraveCommonStaticRedirectNetworkDelegateHelperPerfTest,
+     MANUAL_StaticRedirectTable) {
+  brave::SetUpdateURLHostForTesting(true);
+
+  perf_test::PerfResultReporter reporter(
+      kMetricPrefixStaticRedirect, "common_static_redirect");
+  reporter.RegisterImportantMetric(kMetricPassThroughTime, "us");
+  reporter.RegisterImportantMetric(kMetricRedirectTime, "us");
+
+  MeasureLookups(
+      kMetricPassThroughTime, CreatePassThroughCorpus(), false, &reporter);
+  MeasureLookups(kMetricRedirectTime, CreateRedirectCorpus(), true, &reporter);
+
+  brave::SetUpdateURLHostForTesting(false);
+}
@@ -95,4 +95,12 @@ int OnBeforeURLRequest_HttpsePreFileWork(
   return net::OK;
 }
 
+void OnURLRequestDestroyed_HttpseWork(std::shared_ptr<BraveRequestInfo> ctx) {
+  if (!g_brave_browser_process ||
+      !g_brave_browser_process->https_everywhere_service())
+    return;
+  g_brave_browser_process->https_everywhere_service()->OnRequestDestroyed(
+      ctx->request_identifier);
+}
+
 }  // namespace brave
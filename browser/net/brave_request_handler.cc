@@ -5,11 +5,14 @@
 
 #include "brave/browser/net/brave_request_handler.h"
 
-#include <algorithm>
 #include <utility>
 
+#include "base/metrics/histogram.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/stl_util.h"
+#include "base/strings/strcat.h"
 #include "base/task/post_task.h"
+#include "base/time/time.h"
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 #include "brave/browser/net/brave_common_static_redirect_network_delegate_helper.h"
 #include "brave/browser/net/brave_httpse_network_delegate_helper.h"
@@ -44,12 +47,56 @@
 #include "brave/browser/net/brave_translate_redirect_network_delegate_helper.h"
 #endif
 
-static bool IsInternalScheme(std::shared_ptr<brave::BraveRequestInfo> ctx) {
+namespace {
+
+const char kStageHistogramPrefix[] = "Brave.RequestHandler.";
+
+bool IsInternalScheme(std::shared_ptr<brave::BraveRequestInfo> ctx) {
   DCHECK(ctx);
   return ctx->request_url.SchemeIs(extensions::kExtensionScheme) ||
          ctx->request_url.SchemeIs(content::kChromeUIScheme);
 }
 
+const char* EventTypeToString(brave::BraveNetworkDelegateEventType type) {
+  switch (type) {
+    case brave::kOnBeforeRequest:
+      return "OnBeforeURLRequest";
+    case brave::kOnBeforeStartTransaction:
+      return "OnBeforeStartTransaction";
+    case brave::kOnHeadersReceived:
+      return "OnHeadersReceived";
+    default:
+      NOTREACHED();
+      return "Unknown";
+  }
+}
+
+int RunBeforeStartTransactionStage(
+    const brave::OnBeforeStartTransactionCallback& callback,
+    const brave::ResponseCallback& next_callback,
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  return callback.Run(ctx->headers, next_callback, ctx);
+}
+
+int RunHeadersReceivedStage(const brave::OnHeadersReceivedCallback& callback,
+                            const brave::ResponseCallback& next_callback,
+                            std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  return callback.Run(ctx->original_response_headers,
+                      ctx->override_response_headers,
+                      ctx->allowed_unsafe_redirect_url, next_callback, ctx);
+}
+
+}  // namespace
+
+BraveRequestHandler::Stage::Stage(
+    base::HistogramBase* histogram,
+    const brave::OnBeforeURLRequestCallback& callback)
+    : histogram(histogram), callback(callback) {}
+
+BraveRequestHandler::Stage::Stage(const Stage&) = default;
+
+BraveRequestHandler::Stage::~Stage() = default;
+
 BraveRequestHandler::BraveRequestHandler() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   SetupCallbacks();
@@ -59,45 +106,63 @@ BraveRequestHandler::BraveRequestHandler() {
 
 BraveRequestHandler::~BraveRequestHandler() = default;
 
-void BraveRequestHandler::SetupCallbacks() {
-  brave::OnBeforeURLRequestCallback callback =
-      base::Bind(brave::OnBeforeURLRequest_SiteHacksWork);
-  before_url_request_callbacks_.push_back(callback);
-
-  callback = base::Bind(brave::OnBeforeURLRequest_AdBlockTPPreWork);
-  before_url_request_callbacks_.push_back(callback);
-
-  callback = base::Bind(brave::OnBeforeURLRequest_HttpsePreFileWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::AddStage(
+    brave::BraveNetworkDelegateEventType event_type,
+    const char* name,
+    const brave::OnBeforeURLRequestCallback& callback) {
+  // Most stages finish well under a millisecond, so the buckets are in
+  // microseconds up to 100 ms.
+  base::HistogramBase* histogram = base::Histogram::FactoryMicrosecondsTimeGet(
+      base::StrCat({kStageHistogramPrefix, EventTypeToString(event_type), ".",
+                    name}),
+      base::TimeDelta::FromMicroseconds(1),
+      base::TimeDelta::FromMilliseconds(100), 50,
+      base::HistogramBase::kUmaTargetedHistogramFlag);
+  stages_[event_type].emplace_back(histogram, callback);
+}
 
-  callback = base::Bind(brave::OnBeforeURLRequest_CommonStaticRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::SetupCallbacks() {
+  AddStage(brave::kOnBeforeRequest, "SiteHacks",
+           base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork));
+  AddStage(brave::kOnBeforeRequest, "AdBlockTP",
+           base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork));
+  AddStage(brave::kOnBeforeRequest, "HTTPSE",
+           base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork));
+  AddStage(
+      brave::kOnBeforeRequest, "CommonStaticRedirect",
+      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork));
 
 #if BUILDFLAG(BRAVE_REWARDS_ENABLED)
-  callback = base::Bind(brave_rewards::OnBeforeURLRequest);
-  before_url_request_callbacks_.push_back(callback);
+  AddStage(brave::kOnBeforeRequest, "Rewards",
+           base::BindRepeating(brave_rewards::OnBeforeURLRequest));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStage(
+      brave::kOnBeforeRequest, "TranslateRedirect",
+      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork));
 #endif
 
-  brave::OnBeforeStartTransactionCallback start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_SiteHacksWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddStage(brave::kOnBeforeStartTransaction, "SiteHacks",
+           base::BindRepeating(
+               &RunBeforeStartTransactionStage,
+               base::BindRepeating(
+                   brave::OnBeforeStartTransaction_SiteHacksWork)));
 
 #if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
-  start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_ReferralsWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddStage(brave::kOnBeforeStartTransaction, "Referrals",
+           base::BindRepeating(
+               &RunBeforeStartTransactionStage,
+               base::BindRepeating(
+                   brave::OnBeforeStartTransaction_ReferralsWork)));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
-  brave::OnHeadersReceivedCallback headers_received_callback =
-      base::Bind(webtorrent::OnHeadersReceived_TorrentRedirectWork);
-  headers_received_callbacks_.push_back(headers_received_callback);
+  AddStage(brave::kOnHeadersReceived, "TorrentRedirect",
+           base::BindRepeating(
+               &RunHeadersReceivedStage,
+               base::BindRepeating(
+                   webtorrent::OnHeadersReceived_TorrentRedirectWork)));
 #endif
 }
 
@@ -133,30 +198,26 @@ int BraveRequestHandler::OnBeforeURLRequest(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     GURL* new_url) {
-  if (before_url_request_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (IsInternalScheme(ctx)) {
     return net::OK;
   }
   SCOPED_UMA_HISTOGRAM_TIMER("Brave.OnBeforeURLRequest_Handler");
   ctx->new_url = new_url;
   ctx->event_type = brave::kOnBeforeRequest;
-  callbacks_[ctx->request_identifier] = std::move(callback);
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartPipeline(ctx, std::move(callback));
 }
 
 int BraveRequestHandler::OnBeforeStartTransaction(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     net::HttpRequestHeaders* headers) {
-  if (before_start_transaction_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (IsInternalScheme(ctx)) {
     return net::OK;
   }
   ctx->event_type = brave::kOnBeforeStartTransaction;
   ctx->headers = headers;
   ctx->referral_headers_list = referral_headers_list_.get();
-  callbacks_[ctx->request_identifier] = std::move(callback);
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartPipeline(ctx, std::move(callback));
 }
 
 int BraveRequestHandler::OnHeadersReceived(
@@ -171,125 +232,114 @@ int BraveRequestHandler::OnHeadersReceived(
         original_response_headers, override_response_headers);
   }
 
-  if (headers_received_callbacks_.empty() &&
-      !ctx->request_url.SchemeIs(content::kChromeUIScheme)) {
-    // Extension scheme not excluded since brave_webtorrent needs it.
-    return net::OK;
-  }
-
-  callbacks_[ctx->request_identifier] = std::move(callback);
+  // Extension scheme not excluded since brave_webtorrent needs it.
   ctx->event_type = brave::kOnHeadersReceived;
   ctx->original_response_headers = original_response_headers;
   ctx->override_response_headers = override_response_headers;
   ctx->allowed_unsafe_redirect_url = allowed_unsafe_redirect_url;
-
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartPipeline(ctx, std::move(callback));
 }
 
 void BraveRequestHandler::OnURLRequestDestroyed(
     std::shared_ptr<brave::BraveRequestInfo> ctx) {
-  if (base::Contains(callbacks_, ctx->request_identifier)) {
-    callbacks_.erase(ctx->request_identifier);
-  }
+  callbacks_.erase(ctx->request_identifier);
+  brave::OnURLRequestDestroyed_HttpseWork(ctx);
 }
 
 void BraveRequestHandler::RunCallbackForRequestIdentifier(
     uint64_t request_identifier,
     int rv) {
-  std::map<uint64_t, net::CompletionOnceCallback>::iterator it =
-      callbacks_.find(request_identifier);
+  auto it = callbacks_.find(request_identifier);
+  if (it == callbacks_.end()) {
+    return;
+  }
+  net::CompletionOnceCallback callback = std::move(it->second);
+  callbacks_.erase(it);
   // We intentionally do the async call to maintain the proper flow
   // of URLLoader callbacks.
   base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                 base::BindOnce(std::move(it->second), rv));
+                 base::BindOnce(std::move(callback), rv));
 }
 
-// TODO(iefremov): Merge all callback containers into one and run only one loop
-// instead of many (issues/5574).
-void BraveRequestHandler::RunNextCallback(
-    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+int BraveRequestHandler::StartPipeline(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    net::CompletionOnceCallback callback) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  ctx->next_url_request_index = 0;
+  int rv = RunStages(ctx);
+  if (rv == net::OK) {
+    return net::OK;
+  }
 
-  if (!base::Contains(callbacks_, ctx->request_identifier)) {
-    return;
+  callbacks_[ctx->request_identifier] = std::move(callback);
+  if (rv != net::ERR_IO_PENDING) {
+    // Callers only handle a few errors synchronously, so failures are still
+    // reported through |callback|.
+    RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
   }
+  return net::ERR_IO_PENDING;
+}
 
-  // Continue processing callbacks until we hit one that returns PENDING
-  int rv = net::OK;
+int BraveRequestHandler::RunStages(
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
-  if (ctx->event_type == brave::kOnBeforeRequest) {
-    while (before_url_request_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeURLRequestCallback callback =
-          before_url_request_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback = base::Bind(
-          &BraveRequestHandler::RunNextCallback,
-          weak_factory_.GetWeakPtr(),
-          ctx);
-      rv = callback.Run(next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
+  auto stages = stages_.find(ctx->event_type);
+  if (stages != stages_.end()) {
+    const brave::ResponseCallback next_callback =
+        base::BindRepeating(&BraveRequestHandler::RunNextCallback,
+                            weak_factory_.GetWeakPtr(), ctx);
+    while (ctx->next_url_request_index < stages->second.size()) {
+      const Stage& stage = stages->second[ctx->next_url_request_index++];
+      const base::TimeTicks start = base::TimeTicks::Now();
+      ctx->running_stage = true;
+      ctx->stage_completed_inline = false;
+      int rv = stage.callback.Run(next_callback, ctx);
+      ctx->running_stage = false;
+      stage.histogram->AddTimeMicrosecondsGranularity(base::TimeTicks::Now() -
+                                                      start);
+      if (rv == net::ERR_IO_PENDING && ctx->stage_completed_inline) {
+        rv = net::OK;
       }
       if (rv != net::OK) {
-        break;
+        return rv;
       }
     }
-  } else if (ctx->event_type == brave::kOnBeforeStartTransaction) {
-    while (before_start_transaction_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeStartTransactionCallback callback =
-          before_start_transaction_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback = base::Bind(
-          &BraveRequestHandler::RunNextCallback,
-          weak_factory_.GetWeakPtr(),
-          ctx);
-      rv = callback.Run(ctx->headers, next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
-    }
-  } else if (ctx->event_type == brave::kOnHeadersReceived) {
-    while (headers_received_callbacks_.size() != ctx->next_url_request_index) {
-      brave::OnHeadersReceivedCallback callback =
-          headers_received_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback = base::Bind(
-          &BraveRequestHandler::RunNextCallback,
-          weak_factory_.GetWeakPtr(),
-          ctx);
-      rv = callback.Run(ctx->original_response_headers,
-                        ctx->override_response_headers,
-                        ctx->allowed_unsafe_redirect_url, next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
-    }
-  }
-
-  if (rv != net::OK) {
-    RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
-    return;
   }
 
   if (ctx->event_type == brave::kOnBeforeRequest) {
     if (!ctx->new_url_spec.empty() &&
-        (ctx->new_url_spec != ctx->request_url.spec()) &&
-        IsRequestIdentifierValid(ctx->request_identifier)) {
+        (ctx->new_url_spec != ctx->request_url.spec())) {
       *ctx->new_url = GURL(ctx->new_url_spec);
     }
-    if (ctx->blocked_by == brave::kAdBlocked) {
-      if (ctx->cancel_request_explicitly) {
-        RunCallbackForRequestIdentifier(ctx->request_identifier,
-                                        net::ERR_ABORTED);
-        return;
-      }
+    if (ctx->blocked_by == brave::kAdBlocked &&
+        ctx->cancel_request_explicitly) {
+      return net::ERR_ABORTED;
     }
   }
+  return net::OK;
+}
+
+void BraveRequestHandler::RunNextCallback(
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+
+  // The stage finished before returning, so RunStages carries on with the
+  // next one once it does. Resuming here would run the rest of the pipeline
+  // twice, or not at all while the completion callback isn't stored yet.
+  if (ctx->running_stage) {
+    ctx->stage_completed_inline = true;
+    return;
+  }
+
+  // The request may have been destroyed while the stage was running.
+  if (!IsRequestIdentifierValid(ctx->request_identifier)) {
+    return;
+  }
+
+  int rv = RunStages(ctx);
+  if (rv == net::ERR_IO_PENDING) {
+    return;
+  }
   RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
 }
@@ -0,0 +1,83 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_shields_settings_cache.h"
+
+#include "base/memory/ptr_util.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace brave {
+
+namespace {
+
+// User data key for ShieldsSettingsCache.
+const void* const kShieldsSettingsCacheUserDataKey =
+    &kShieldsSettingsCacheUserDataKey;
+
+// Enough for the tabs of a busy window; each entry is a handful of bools.
+const size_t kShieldsSettingsCacheSize = 64;
+
+}  // namespace
+
+ShieldsSettingsCache::ShieldsSettingsCache(HostContentSettingsMap* map)
+    : map_(map), snapshots_(kShieldsSettingsCacheSize) {
+  map_->AddObserver(this);
+}
+
+ShieldsSettingsCache::~ShieldsSettingsCache() {
+  map_->RemoveObserver(this);
+}
+
+// static
+ShieldsSettingsCache* ShieldsSettingsCache::GetForBrowserContext(
+    content::BrowserContext* browser_context) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto* self = static_cast<ShieldsSettingsCache*>(
+      browser_context->GetUserData(kShieldsSettingsCacheUserDataKey));
+  if (!self) {
+    self = new ShieldsSettingsCache(HostContentSettingsMapFactory::GetForProfile(
+        Profile::FromBrowserContext(browser_context)));
+    browser_context->SetUserData(kShieldsSettingsCacheUserDataKey,
+                                 base::WrapUnique(self));
+  }
+  return self;
+}
+
+const ShieldsSettingsSnapshot& ShieldsSettingsCache::Get(
+    const GURL& tab_origin) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto it = snapshots_.Get(tab_origin);
+  if (it != snapshots_.end()) {
+    return it->second;
+  }
+
+  ShieldsSettingsSnapshot snapshot;
+  snapshot.allow_brave_shields =
+      brave_shields::GetBraveShieldsEnabled(map_.get(), tab_origin);
+  snapshot.allow_ads = brave_shields::GetAdControlType(
+      map_.get(), tab_origin) == brave_shields::ControlType::ALLOW;
+  snapshot.allow_http_upgradable_resource =
+      !brave_shields::GetHTTPSEverywhereEnabled(map_.get(), tab_origin);
+  snapshot.allow_referrers =
+      brave_shields::AllowReferrers(map_.get(), tab_origin);
+  return snapshots_.Put(tab_origin, snapshot)->second;
+}
+
+void ShieldsSettingsCache::OnContentSettingChanged(
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern,
+    ContentSettingsType content_type,
+    const std::string& resource_identifier) {
+  // All the shields settings in a snapshot are stored as PLUGINS.
+  if (content_type == ContentSettingsType::PLUGINS) {
+    snapshots_.Clear();
+  }
+}
+
+}  // namespace brave
@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_BRAVE_SHIELDS_SETTINGS_CACHE_H_
+#define BRAVE_BROWSER_NET_BRAVE_SHIELDS_SETTINGS_CACHE_H_
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/supports_user_data.h"
+#include "components/content_settings/core/browser/content_settings_observer.h"
+#include "url/gurl.h"
+
+class HostContentSettingsMap;
+
+namespace content {
+class BrowserContext;
+}
+
+namespace brave {
+
+// The shields settings BraveRequestInfo::FillCTX needs for a tab origin.
+struct ShieldsSettingsSnapshot {
+  bool allow_brave_shields = true;
+  bool allow_ads = false;
+  bool allow_http_upgradable_resource = false;
+  bool allow_referrers = false;
+};
+
+// Per-profile cache of ShieldsSettingsSnapshot keyed by tab origin, so that
+// the subresources of a page share the lookups made for its navigation. The
+// cache is dropped whenever a shields content setting changes.
+class ShieldsSettingsCache : public base::SupportsUserData::Data,
+                             public content_settings::Observer {
+ public:
+  ~ShieldsSettingsCache() override;
+
+  static ShieldsSettingsCache* GetForBrowserContext(
+      content::BrowserContext* browser_context);
+
+  const ShieldsSettingsSnapshot& Get(const GURL& tab_origin);
+
+ private:
+  explicit ShieldsSettingsCache(HostContentSettingsMap* map);
+
+  // content_settings::Observer overrides:
+  void OnContentSettingChanged(const ContentSettingsPattern& primary_pattern,
+                               const ContentSettingsPattern& secondary_pattern,
+                               ContentSettingsType content_type,
+                               const std::string& resource_identifier) override;
+
+  scoped_refptr<HostContentSettingsMap> map_;
+  base::MRUCache<GURL, ShieldsSettingsSnapshot> snapshots_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsCache);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_BRAVE_SHIELDS_SETTINGS_CACHE_H_
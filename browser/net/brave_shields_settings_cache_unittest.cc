@@ -0,0 +1,69 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_shields_settings_cache.h"
+
+#include <memory>
+
+#include "base/macros.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/test/base/testing_profile.h"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave::ShieldsSettingsCache;
+using brave::ShieldsSettingsSnapshot;
+
+class BraveShieldsSettingsCacheTest : public testing::Test {
+ public:
+  BraveShieldsSettingsCacheTest() = default;
+  ~BraveShieldsSettingsCacheTest() override = default;
+
+  void SetUp() override { profile_ = std::make_unique<TestingProfile>(); }
+
+  TestingProfile* profile() { return profile_.get(); }
+  HostContentSettingsMap* map() {
+    return HostContentSettingsMapFactory::GetForProfile(profile());
+  }
+
+ private:
+  content::BrowserTaskEnvironment task_environment_;
+  std::unique_ptr<TestingProfile> profile_;
+
+  DISALLOW_COPY_AND_ASSIGN(BraveShieldsSettingsCacheTest);
+};
+
+TEST_F(BraveShieldsSettingsCacheTest, Defaults) {
+  ShieldsSettingsCache* cache =
+      ShieldsSettingsCache::GetForBrowserContext(profile());
+  EXPECT_EQ(cache, ShieldsSettingsCache::GetForBrowserContext(profile()));
+
+  const ShieldsSettingsSnapshot& settings =
+      cache->Get(GURL("https://brave.com/"));
+  EXPECT_TRUE(settings.allow_brave_shields);
+  EXPECT_FALSE(settings.allow_ads);
+  EXPECT_FALSE(settings.allow_http_upgradable_resource);
+  EXPECT_FALSE(settings.allow_referrers);
+}
+
+TEST_F(BraveShieldsSettingsCacheTest, InvalidatedOnSettingChange) {
+  const GURL url("https://brave.com/");
+  ShieldsSettingsCache* cache =
+      ShieldsSettingsCache::GetForBrowserContext(profile());
+  EXPECT_TRUE(cache->Get(url).allow_brave_shields);
+  EXPECT_FALSE(cache->Get(url).allow_ads);
+
+  brave_shields::SetBraveShieldsEnabled(map(), false, url);
+  EXPECT_FALSE(cache->Get(url).allow_brave_shields);
+  EXPECT_TRUE(cache->Get(GURL("https://example.com/")).allow_brave_shields);
+
+  brave_shields::SetAdControlType(map(), brave_shields::ControlType::ALLOW,
+                                  url);
+  EXPECT_TRUE(cache->Get(url).allow_ads);
+
+  brave_shields::SetHTTPSEverywhereEnabled(map(), false, url);
+  EXPECT_TRUE(cache->Get(url).allow_http_upgradable_resource);
+}
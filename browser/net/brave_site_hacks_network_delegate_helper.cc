@@ -7,11 +7,12 @@
 
 #include <memory>
 #include <string>
-#include <vector>
 
-#include "base/lazy_instance.h"
+#include "base/containers/flat_set.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/no_destructor.h"
+#include "base/stl_util.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/network_constants.h"
@@ -21,67 +22,86 @@
 #include "content/public/common/referrer.h"
 #include "extensions/common/url_pattern.h"
 #include "net/url_request/url_request.h"
-#include "third_party/re2/src/re2/re2.h"
 
 namespace brave {
 
 namespace {
 
-const std::string& GetQueryStringTrackers() {
-  static const base::NoDestructor<std::string> trackers(base::JoinString(
-      std::vector<std::string>(
+struct CaseInsensitiveLess {
+  bool operator()(base::StringPiece a, base::StringPiece b) const {
+    return base::CompareCaseInsensitiveASCII(a, b) < 0;
+  }
+};
+
+using QueryStringTrackers =
+    base::flat_set<base::StringPiece, CaseInsensitiveLess>;
+
+const QueryStringTrackers& GetQueryStringTrackers() {
+  static const base::NoDestructor<QueryStringTrackers> trackers(
+      std::initializer_list<base::StringPiece>(
           {// https://github.com/brave/brave-browser/issues/4239
            "fbclid", "gclid", "msclkid", "mc_eid",
            // https://github.com/brave/brave-browser/issues/9879
            "dclid",
            // https://github.com/brave/brave-browser/issues/9019
-           "_hsenc", "__hssc", "__hstc", "__hsfp", "hsCtaTracking"}),
-      "|"));
+           "_hsenc", "__hssc", "__hstc", "__hsfp", "hsCtaTracking"}));
   return *trackers;
 }
 
-// From src/components/autofill/content/renderer/page_passwords_analyser.cc
-// and password_form_conversion_utils.cc:
-#define DECLARE_LAZY_MATCHER(NAME, PATTERN)                                   \
-  struct LabelPatternLazyInstanceTraits_##NAME                                \
-      : public base::internal::DestructorAtExitLazyInstanceTraits<re2::RE2> { \
-    static re2::RE2* New(void* instance) {                                    \
-      re2::RE2::Options options;                                              \
-      options.set_case_sensitive(false);                                      \
-      re2::RE2* matcher = new (instance) re2::RE2(PATTERN, options);          \
-      DCHECK(matcher->ok());                                                  \
-      return matcher;                                                         \
-    }                                                                         \
-  };                                                                          \
-  base::LazyInstance<re2::RE2, LabelPatternLazyInstanceTraits_##NAME> NAME =  \
-      LAZY_INSTANCE_INITIALIZER
-
-// e.g. "?fbclid=1234"
-DECLARE_LAZY_MATCHER(tracker_only_matcher,
-                     "^(" + GetQueryStringTrackers() + ")=[^&]+$");
-
-// e.g. "?fbclid=1234&foo=1"
-DECLARE_LAZY_MATCHER(tracker_first_matcher,
-                     "^(" + GetQueryStringTrackers() + ")=[^&]+&");
-
-// e.g. "?foo=1&fbclid=1234" or "?foo=1&fbclid=1234&bar=2"
-DECLARE_LAZY_MATCHER(tracker_appended_matcher,
-                     "&(" + GetQueryStringTrackers() + ")=[^&]+");
-
-#undef DECLARE_LAZY_MATCHER
+// Only parameters with a value are stripped, e.g. "fbclid=1" but neither
+// "fbclid" nor "fbclid=".
+bool IsTrackerParameter(base::StringPiece parameter) {
+  const size_t equals = parameter.find('=');
+  if (equals == base::StringPiece::npos || equals + 1 == parameter.size()) {
+    return false;
+  }
+  return base::Contains(GetQueryStringTrackers(), parameter.substr(0, equals));
+}
 
 void ApplyPotentialQueryStringFilter(const GURL& request_url,
                                      std::string* new_url_spec) {
   DCHECK(new_url_spec);
   SCOPED_UMA_HISTOGRAM_TIMER("Brave.SiteHacks.QueryFilter");
-  std::string new_query = request_url.query();
-  // Note: the ordering of these replacements is important.
-  const int replacement_count =
-      re2::RE2::GlobalReplace(&new_query, tracker_appended_matcher.Get(), "") +
-      re2::RE2::GlobalReplace(&new_query, tracker_first_matcher.Get(), "") +
-      re2::RE2::GlobalReplace(&new_query, tracker_only_matcher.Get(), "");
-
-  if (replacement_count > 0) {
+  const base::StringPiece query = request_url.query_piece();
+
+  // Walks the "&" separated parameters once. Nothing is copied until the
+  // first tracker is found; from then on the kept parameters are appended
+  // to |new_query|.
+  bool stripped = false;
+  size_t kept_count = 0;
+  std::string new_query;
+  size_t start = 0;
+  while (true) {
+    size_t end = query.find('&', start);
+    if (end == base::StringPiece::npos) {
+      end = query.size();
+    }
+    const base::StringPiece parameter = query.substr(start, end - start);
+    if (IsTrackerParameter(parameter)) {
+      if (!stripped) {
+        stripped = true;
+        if (start > 0) {
+          // Everything before this parameter, without the trailing "&".
+          query.substr(0, start - 1).CopyToString(&new_query);
+        }
+      }
+    } else {
+      if (stripped) {
+        if (kept_count > 0) {
+          new_query += '&';
+        }
+        parameter.AppendToString(&new_query);
+      }
+      ++kept_count;
+    }
+
+    if (end == query.size()) {
+      break;
+    }
+    start = end + 1;
+  }
+
+  if (stripped) {
     url::Replacements<char> replacements;
     if (new_query.empty()) {
       replacements.ClearQuery();
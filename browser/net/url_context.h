@@ -10,7 +10,9 @@
 #include <set>
 #include <string>
 
+#include "base/memory/scoped_refptr.h"
 #include "net/url_request/url_request.h"
+#include "services/network/public/cpp/resource_request_body.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 #include "url/gurl.h"
 
@@ -76,6 +78,10 @@ struct BraveRequestInfo {
   int frame_tree_node_id = 0;
   uint64_t request_identifier = 0;
   size_t next_url_request_index = 0;
+  // Set by BraveRequestHandler while a stage runs, and when that stage runs
+  // its next callback before returning.
+  bool running_stage = false;
+  bool stage_completed_inline = false;
 
   net::HttpRequestHeaders* headers = nullptr;
   // The following two sets are populated by |OnBeforeStartTransactionCallback|.
@@ -100,7 +106,13 @@ struct BraveRequestInfo {
       static_cast<blink::mojom::ResourceType>(-1);
   blink::mojom::ResourceType resource_type = kInvalidResourceType;
 
-  std::string upload_data;
+  // Body of the request, shared with the ResourceRequest rather than
+  // copied. Stages which need its contents call GetUploadData().
+  scoped_refptr<network::ResourceRequestBody> request_body;
+
+  // Returns the concatenated bytes elements of |request_body|. This copies
+  // the body, so it should only be called once a stage knows it needs it.
+  std::string GetUploadData() const;
 
   static void FillCTX(const network::ResourceRequest& request,
                       int render_process_id,
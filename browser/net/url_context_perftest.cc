@@ -0,0 +1,81 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/url_context.h"
+
+#include <memory>
+#include <string>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "services/network/public/cpp/resource_request_body.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_unit_tests --filter=BraveRequestInfoPerfTest.* \
+//     --run-manual
+
+namespace {
+
+const char kMetricPrefixRequestBody[] = "RequestBody.";
+const char kMetricShareBodyTime[] = "share_body_time";
+const char kMetricCopyBodyTime[] = "copy_body_time";
+
+// Bytes elements of |element_size| bytes, |element_count| of them, as a
+// multipart upload sends
+scoped_refptr<network::ResourceRequestBody> CreateBody(
+    const size_t element_size,
+    const int element_count) {
+  auto body = base::MakeRefCounted<network::ResourceRequestBody>();
+  const std::string bytes(element_size, 'x');
+  for (int i = 0; i < element_count; ++i) {
+    body->AppendBytes(bytes.data(), bytes.size());
+  }
+  return body;
+}
+
+// Time to put |body| on a request's BraveRequestInfo, as FillCTX does, and
+// to copy it out as FillCTX did for every request before bodies were shared.
+void MeasureBody(const std::string& story,
+                 scoped_refptr<network::ResourceRequestBody> body) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixRequestBody, story);
+  reporter.RegisterImportantMetric(kMetricShareBodyTime, "us");
+  reporter.RegisterImportantMetric(kMetricCopyBodyTime, "us");
+
+  const GURL url("https://upload.example.com/upload");
+  size_t bytes = 0;
+
+  base::LapTimer share_timer;
+  do {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(url);
+    ctx->request_body = body;
+    bytes += ctx->request_body->elements()->size();
+    share_timer.NextLap();
+  } while (!share_timer.HasTimeLimitExpired());
+  reporter.AddResult(kMetricShareBodyTime, share_timer.TimePerLap());
+
+  base::LapTimer copy_timer;
+  do {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(url);
+    ctx->request_body = body;
+    bytes += ctx->GetUploadData().size();
+    copy_timer.NextLap();
+  } while (!copy_timer.HasTimeLimitExpired());
+  reporter.AddResult(kMetricCopyBodyTime, copy_timer.TimePerLap());
+
+  // Keeps the copies from being optimized away
+  EXPECT_GT(bytes, 0u);
+}
+
+}  // namespace
+
+// A form post, a photo upload and a large multipart file upload.
+TEST(BraveRequestInfoPerfTest, MANUAL_UploadData) {
+  MeasureBody("form_2kb", CreateBody(2 * 1024, 1));
+  MeasureBody("photo_4mb", CreateBody(4 * 1024 * 1024, 1));
+  MeasureBody("multipart_64mb", CreateBody(1024 * 1024, 64));
+}
@@ -5,7 +5,12 @@
 
 #include "third_party/blink/renderer/core/dom/document.h"
 
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
 #include "base/strings/string_number_conversions.h"
+#include "brave/third_party/blink/renderer/brave_audio_farbling_helpers.h"
 #include "brave/third_party/blink/renderer/brave_farbling_constants.h"
 #include "crypto/hmac.h"
 #include "third_party/blink/public/platform/web_content_settings_client.h"
@@ -13,12 +18,16 @@
 #include "third_party/blink/renderer/core/frame/local_dom_window.h"
 #include "third_party/blink/renderer/core/frame/local_frame.h"
 #include "third_party/blink/renderer/platform/bindings/script_state.h"
-#include "third_party/blink/renderer/platform/graphics/image_data_buffer.h"
 #include "third_party/blink/renderer/platform/graphics/static_bitmap_image.h"
 #include "third_party/blink/renderer/platform/graphics/unaccelerated_static_bitmap_image.h"
 #include "third_party/blink/renderer/platform/heap/handle.h"
 #include "third_party/blink/renderer/platform/network/network_utils.h"
 #include "third_party/blink/renderer/platform/supplementable.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
 
 namespace {
 
@@ -33,12 +42,6 @@ std::string TopETLDPlusOneForDoc(const Document& doc) {
       blink::network_utils::kIncludePrivateRegistries).Utf8();
 }
 
-const uint64_t zero = 0;
-
-inline uint64_t lfsr_next(uint64_t v) {
-  return ((v >> 1) | (((v << 62) ^ (v << 61)) & (~(~zero << 63) << 62)));
-}
-
 float Identity(float value, size_t index) {
   return value;
 }
@@ -47,18 +50,54 @@ float ConstantMultiplier(double fudge_factor, float value, size_t index) {
   return value * fudge_factor;
 }
 
-float PseudoRandomSequence(uint64_t seed, float value, size_t index) {
-  static uint64_t v;
+float PseudoRandomSequence(uint64_t seed,
+                           uint64_t* state,
+                           float value,
+                           size_t index) {
   const double maxUInt64AsDouble = UINT64_MAX;
   if (index == 0) {
     // start of loop, reset to initial seed which was passed in and is based on
     // the domain key
-    v = seed;
+    *state = seed;
   }
   // get next value in PRNG sequence
-  v = lfsr_next(v);
+  *state = brave::LfsrNext(*state);
   // return pseudo-random float between 0 and 0.1
-  return (v / maxUInt64AsDouble) / 10;
+  return (*state / maxUInt64AsDouble) / 10;
+}
+
+// Canvases with up to this many pixels are hashed in full. Larger ones are
+// sampled at an even stride, so hashing cost does not grow with canvas size.
+const size_t kMaxCanvasHashPixels = 4096;
+
+// Returns an evenly spaced sample of at most kMaxCanvasHashPixels RGBA pixels.
+std::string SampleCanvasPixels(base::span<const uint8_t> pixels) {
+  const size_t pixel_count = pixels.size() / 4;
+  const size_t stride =
+      std::max<size_t>(1, (pixel_count + kMaxCanvasHashPixels - 1) /
+                              kMaxCanvasHashPixels);
+  std::string sample;
+  sample.reserve(4 * std::min(pixel_count, kMaxCanvasHashPixels));
+  for (size_t i = 0; i < pixel_count; i += stride) {
+    sample.append(reinterpret_cast<const char*>(&pixels[4 * i]), 4);
+  }
+  return sample;
+}
+
+// Canvas keys are a few bytes each; this covers pages that alternate between
+// a handful of canvases.
+const size_t kMaxCachedCanvasKeys = 16;
+
+// Returns a blank image of the given size. A canvas that cannot be farbled
+// is read back as this instead of its real contents. The image is recorded,
+// so no pixels are allocated for it here.
+scoped_refptr<blink::StaticBitmapImage> CreateTransparentImage(int width,
+                                                               int height) {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(width, height);
+  return blink::UnacceleratedStaticBitmapImage::Create(SkImage::MakeFromPicture(
+      recorder.finishRecordingAsPicture(), SkISize::Make(width, height),
+      nullptr, nullptr, SkImage::BitDepth::kU8, SkColorSpace::MakeSRGB()));
 }
 
 }  // namespace
@@ -75,7 +114,7 @@ const char kLettersForRandomStrings[] =
 const size_t kLettersForRandomStringsLength = 64;
 
 BraveSessionCache::BraveSessionCache(Document& document)
-    : Supplement<Document>(document) {
+    : Supplement<Document>(document), canvas_keys_(kMaxCachedCanvasKeys) {
   const std::string domain = TopETLDPlusOneForDoc(document);
   farbling_enabled_ = !domain.empty();
   if (farbling_enabled_) {
@@ -100,83 +139,138 @@ BraveSessionCache& BraveSessionCache::From(Document& document) {
   return *cache;
 }
 
+double BraveSessionCache::GetAudioFudgeFactor() const {
+  const uint64_t* fudge = reinterpret_cast<const uint64_t*>(domain_key_);
+  const double maxUInt64AsDouble = UINT64_MAX;
+  return 0.99 + ((*fudge / maxUInt64AsDouble) / 100);
+}
+
+uint64_t BraveSessionCache::GetAudioSeed() const {
+  return *reinterpret_cast<const uint64_t*>(domain_key_);
+}
+
+BraveFarblingLevel BraveSessionCache::GetFarblingLevel(
+    blink::LocalFrame* frame) {
+  if (!farbling_enabled_ || !frame || !frame->GetContentSettingsClient())
+    return BraveFarblingLevel::OFF;
+  return frame->GetContentSettingsClient()->GetBraveFarblingLevel();
+}
+
 AudioFarblingCallback BraveSessionCache::GetAudioFarblingCallback(
     blink::LocalFrame* frame) {
-  if (farbling_enabled_ && frame && frame->GetContentSettingsClient()) {
-    switch (frame->GetContentSettingsClient()->GetBraveFarblingLevel()) {
-      case BraveFarblingLevel::OFF: {
-        break;
-      }
-      case BraveFarblingLevel::BALANCED: {
-        const uint64_t* fudge = reinterpret_cast<const uint64_t*>(domain_key_);
-        const double maxUInt64AsDouble = UINT64_MAX;
-        double fudge_factor = 0.99 + ((*fudge / maxUInt64AsDouble) / 100);
-        VLOG(1) << "audio fudge factor (based on session token) = "
-                << fudge_factor;
-        return base::BindRepeating(&ConstantMultiplier, fudge_factor);
-      }
-      case BraveFarblingLevel::MAXIMUM: {
-        uint64_t seed = *reinterpret_cast<uint64_t*>(domain_key_);
-       return base::BindRepeating(&PseudoRandomSequence, seed);
-      }
+  switch (GetFarblingLevel(frame)) {
+    case BraveFarblingLevel::OFF: {
+      break;
+    }
+    case BraveFarblingLevel::BALANCED: {
+      double fudge_factor = GetAudioFudgeFactor();
+      VLOG(1) << "audio fudge factor (based on session token) = "
+              << fudge_factor;
+      return base::BindRepeating(&ConstantMultiplier, fudge_factor);
+    }
+    case BraveFarblingLevel::MAXIMUM: {
+      // Each callback owns its PRNG state, so callbacks handed to different
+      // analysers never step on each other's sequence.
+      return base::BindRepeating(&PseudoRandomSequence, GetAudioSeed(),
+                                 base::Owned(new uint64_t(0)));
     }
   }
   return base::BindRepeating(&Identity);
 }
 
+void BraveSessionCache::FarbleAudioChannel(blink::LocalFrame* frame,
+                                           base::span<float> samples) {
+  if (samples.empty())
+    return;
+  switch (GetFarblingLevel(frame)) {
+    case BraveFarblingLevel::OFF:
+      break;
+    case BraveFarblingLevel::BALANCED:
+      MultiplyAudioSamples(samples, GetAudioFudgeFactor());
+      break;
+    case BraveFarblingLevel::MAXIMUM:
+      FillPseudoRandomAudioSamples(samples, GetAudioSeed());
+      break;
+  }
+}
+
 scoped_refptr<blink::StaticBitmapImage> BraveSessionCache::PerturbPixels(
     blink::LocalFrame* frame,
     scoped_refptr<blink::StaticBitmapImage> image_bitmap) {
-  if (!farbling_enabled_ || !frame || !frame->GetContentSettingsClient()) {
+  const BraveFarblingLevel level = GetFarblingLevel(frame);
+  if (level == BraveFarblingLevel::OFF)
+    return image_bitmap;
+  DCHECK(image_bitmap);
+  if (image_bitmap->IsNull())
     return image_bitmap;
+
+  // Perturb a single RGBA copy of the pixels in place. MAXIMUM overwrites
+  // every byte, so it does not need to read the canvas back at all.
+  SkBitmap bitmap;
+  if (!bitmap.tryAllocPixels(
+          SkImageInfo::Make(image_bitmap->width(), image_bitmap->height(),
+                            kRGBA_8888_SkColorType, kUnpremul_SkAlphaType))) {
+    return CreateTransparentImage(image_bitmap->width(),
+                                  image_bitmap->height());
   }
-  switch (frame->GetContentSettingsClient()->GetBraveFarblingLevel()) {
-    case BraveFarblingLevel::OFF:
-      break;
+  base::span<uint8_t> pixels(static_cast<uint8_t*>(bitmap.getPixels()),
+                             bitmap.computeByteSize());
+  switch (level) {
     case BraveFarblingLevel::BALANCED: {
-      image_bitmap = PerturbBalanced(image_bitmap);
+      cc::PaintImage paint_image = image_bitmap->PaintImageForCurrentFrame();
+      sk_sp<SkImage> sk_image = paint_image.GetSkImage();
+      if (!sk_image || !sk_image->readPixels(bitmap.pixmap(), 0, 0)) {
+        return CreateTransparentImage(image_bitmap->width(),
+                                      image_bitmap->height());
+      }
+      PerturbBalanced(paint_image.GetContentIdForFrame(0u), pixels);
       break;
     }
     case BraveFarblingLevel::MAXIMUM: {
-      image_bitmap = PerturbMax(image_bitmap);
+      PerturbMax(pixels);
       break;
     }
     default:
       NOTREACHED();
   }
-  return image_bitmap;
+  bitmap.setImmutable();
+  return blink::UnacceleratedStaticBitmapImage::Create(
+      SkImage::MakeFromBitmap(bitmap));
 }
 
-scoped_refptr<blink::StaticBitmapImage> BraveSessionCache::PerturbBalanced(
-    scoped_refptr<blink::StaticBitmapImage> image_bitmap) {
-  DCHECK(image_bitmap);
-  if (image_bitmap->IsNull())
-    return image_bitmap;
-  // convert to an ImageDataBuffer to normalize the pixel data to RGBA, 4 bytes
-  // per pixel
-  std::unique_ptr<blink::ImageDataBuffer> data_buffer =
-      blink::ImageDataBuffer::Create(image_bitmap);
-  uint8_t* pixels = const_cast<uint8_t*>(data_buffer->Pixels());
-  // This needs to be type size_t because we pass it to base::StringPiece
-  // later for content hashing. This is safe because the maximum canvas
-  // dimensions are less than SIZE_T_MAX. (Width and height are each
-  // limited to 32,767 pixels.)
-  const size_t pixel_count = data_buffer->Width() * data_buffer->Height();
-  // choose which channel (R, G, or B) to perturb
-  const uint8_t* first_byte = reinterpret_cast<const uint8_t*>(domain_key_);
-  uint8_t channel = *first_byte % 3;
-  // calculate initial seed to find first pixel to perturb, based on session
-  // key, domain key, and canvas contents
+BraveSessionCache::CanvasKey BraveSessionCache::GetCanvasKey(
+    cc::PaintImage::ContentId content_id,
+    base::span<const uint8_t> pixels) {
+  if (content_id != cc::PaintImage::kInvalidContentId) {
+    auto it = canvas_keys_.Get(content_id);
+    if (it != canvas_keys_.end())
+      return it->second;
+  }
+  // based on session key, domain key, and a sample of the canvas contents
   crypto::HMAC h(crypto::HMAC::SHA256);
   uint64_t session_plus_domain_key =
       session_key_ ^ *reinterpret_cast<uint64_t*>(domain_key_);
   CHECK(h.Init(reinterpret_cast<const unsigned char*>(&session_plus_domain_key),
                sizeof session_plus_domain_key));
-  uint8_t canvas_key[32];
-  CHECK(h.Sign(
-      base::StringPiece(reinterpret_cast<const char*>(pixels), pixel_count),
-      canvas_key, sizeof canvas_key));
-  uint64_t v = *reinterpret_cast<uint64_t*>(canvas_key);
+  CanvasKey canvas_key;
+  CHECK(h.Sign(SampleCanvasPixels(pixels), canvas_key.data(),
+               canvas_key.size()));
+  if (content_id != cc::PaintImage::kInvalidContentId)
+    canvas_keys_.Put(content_id, canvas_key);
+  return canvas_key;
+}
+
+void BraveSessionCache::PerturbBalanced(cc::PaintImage::ContentId content_id,
+                                        base::span<uint8_t> pixels) {
+  const size_t pixel_count = pixels.size() / 4;
+  if (!pixel_count)
+    return;
+  // choose which channel (R, G, or B) to perturb
+  const uint8_t* first_byte = reinterpret_cast<const uint8_t*>(domain_key_);
+  uint8_t channel = *first_byte % 3;
+  // calculate initial seed to find first pixel to perturb
+  const CanvasKey canvas_key = GetCanvasKey(content_id, pixels);
+  uint64_t v = *reinterpret_cast<const uint64_t*>(canvas_key.data());
   uint64_t pixel_index;
   // iterate through 32-byte canvas key and use each bit to determine how to
   // perturb the current pixel
@@ -187,39 +281,19 @@ scoped_refptr<blink::StaticBitmapImage> BraveSessionCache::PerturbBalanced(
       pixels[pixel_index] = pixels[pixel_index] ^ (bit & 0x1);
       bit = bit >> 1;
       // find next pixel to perturb
-      v = lfsr_next(v);
+      v = LfsrNext(v);
     }
   }
-  // convert back to a StaticBitmapImage to return to the caller
-  scoped_refptr<blink::StaticBitmapImage> perturbed_bitmap =
-      blink::UnacceleratedStaticBitmapImage::Create(
-          data_buffer->RetainedImage());
-  return perturbed_bitmap;
 }
 
-scoped_refptr<blink::StaticBitmapImage> BraveSessionCache::PerturbMax(
-    scoped_refptr<blink::StaticBitmapImage> image_bitmap) {
-  DCHECK(image_bitmap);
-  if (image_bitmap->IsNull())
-    return image_bitmap;
-  // convert to an ImageDataBuffer to normalize the pixel data to RGBA, 4 bytes
-  // per pixel
-  std::unique_ptr<blink::ImageDataBuffer> data_buffer =
-      blink::ImageDataBuffer::Create(image_bitmap);
-  uint8_t* pixels = const_cast<uint8_t*>(data_buffer->Pixels());
-  const uint64_t count = 4 * data_buffer->Width() * data_buffer->Height();
+void BraveSessionCache::PerturbMax(base::span<uint8_t> pixels) {
   // initial seed based on domain key
   uint64_t v = *reinterpret_cast<uint64_t*>(domain_key_);
   // iterate through pixel data and overwrite with next value in PRNG sequence
-  for (uint64_t i = 0; i < count; i++) {
-    pixels[i] = v % 256;
-    v = lfsr_next(v);
+  for (uint8_t& pixel : pixels) {
+    pixel = v % 256;
+    v = LfsrNext(v);
   }
-  // convert back to a StaticBitmapImage to return to the caller
-  scoped_refptr<blink::StaticBitmapImage> perturbed_bitmap =
-      blink::UnacceleratedStaticBitmapImage::Create(
-          data_buffer->RetainedImage());
-  return perturbed_bitmap;
 }
 
 WTF::String BraveSessionCache::GenerateRandomString(std::string seed,
@@ -236,7 +310,7 @@ WTF::String BraveSessionCache::GenerateRandomString(std::string seed,
   for (wtf_size_t i = 0; i < length; i++) {
     destination[i] =
         kLettersForRandomStrings[v % kLettersForRandomStringsLength];
-    v = lfsr_next(v);
+    v = LfsrNext(v);
   }
   return value;
 }
@@ -8,7 +8,13 @@
 
 #include "../../../../../../../third_party/blink/renderer/core/dom/document.h"
 
+#include <array>
+
 #include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/containers/span.h"
+#include "brave/third_party/blink/renderer/brave_farbling_constants.h"
+#include "cc/paint/paint_image.h"
 
 using blink::Document;
 using blink::GarbageCollected;
@@ -42,20 +48,33 @@ class CORE_EXPORT BraveSessionCache final
 
   AudioFarblingCallback GetAudioFarblingCallback(
       blink::LocalFrame* frame);
+  // Farbles a whole channel of audio samples in place. Prefer this over
+  // running the callback above once per sample.
+  void FarbleAudioChannel(blink::LocalFrame* frame, base::span<float> samples);
   scoped_refptr<blink::StaticBitmapImage> PerturbPixels(
       blink::LocalFrame* frame,
       scoped_refptr<blink::StaticBitmapImage> image_bitmap);
   WTF::String GenerateRandomString(std::string seed, wtf_size_t length);
 
  private:
+  using CanvasKey = std::array<uint8_t, 32>;
+
   bool farbling_enabled_;
   uint64_t session_key_;
   uint8_t domain_key_[32];
+  // Keys of recently perturbed canvas contents, so that reading back an
+  // unchanged canvas again skips hashing it. Only keys are kept, not pixels.
+  base::MRUCache<cc::PaintImage::ContentId, CanvasKey> canvas_keys_;
 
-  scoped_refptr<blink::StaticBitmapImage> PerturbBalanced(
-      scoped_refptr<blink::StaticBitmapImage> image_bitmap);
-  scoped_refptr<blink::StaticBitmapImage> PerturbMax(
-      scoped_refptr<blink::StaticBitmapImage> image_bitmap);
+  // Returns OFF for documents without a top-level site to farble for.
+  BraveFarblingLevel GetFarblingLevel(blink::LocalFrame* frame);
+  double GetAudioFudgeFactor() const;
+  uint64_t GetAudioSeed() const;
+  CanvasKey GetCanvasKey(cc::PaintImage::ContentId content_id,
+                         base::span<const uint8_t> pixels);
+  void PerturbBalanced(cc::PaintImage::ContentId content_id,
+                       base::span<uint8_t> pixels);
+  void PerturbMax(base::span<uint8_t> pixels);
 };
 }  // namespace brave
 
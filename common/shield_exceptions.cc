@@ -9,33 +9,31 @@
 #include <map>
 #include <vector>
 
+#include "base/no_destructor.h"
+#include "brave/common/url_pattern_host_index.h"
 #include "extensions/common/url_pattern.h"
 #include "url/gurl.h"
 
 namespace brave {
 
 bool IsUAWhitelisted(const GURL& gurl) {
-  static std::vector<URLPattern> whitelist_patterns({
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.adobe.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.duckduckgo.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.brave.com/*"),
-    // For Widevine
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.netflix.com/*")
-  });
-  return std::any_of(whitelist_patterns.begin(), whitelist_patterns.end(),
-      [&gurl](URLPattern pattern){
-        return pattern.MatchesURL(gurl);
-      });
+  static const base::NoDestructor<URLPatternHostIndex> whitelist_patterns(
+      std::vector<URLPattern>({
+          URLPattern(URLPattern::SCHEME_ALL, "https://*.adobe.com/*"),
+          URLPattern(URLPattern::SCHEME_ALL, "https://*.duckduckgo.com/*"),
+          URLPattern(URLPattern::SCHEME_ALL, "https://*.brave.com/*"),
+          // For Widevine
+          URLPattern(URLPattern::SCHEME_ALL, "https://*.netflix.com/*"),
+      }));
+  return whitelist_patterns->Matches(gurl);
 }
 
 bool IsBlockedResource(const GURL& gurl) {
-  static std::vector<URLPattern> blocked_patterns({
-      URLPattern(URLPattern::SCHEME_ALL, "https://pdfjs.robwu.nl/*")
-  });
-  return std::any_of(blocked_patterns.begin(), blocked_patterns.end(),
-                     [&gurl](URLPattern pattern){
-                       return pattern.MatchesURL(gurl);
-                     });
+  static const base::NoDestructor<URLPatternHostIndex> blocked_patterns(
+      std::vector<URLPattern>({
+          URLPattern(URLPattern::SCHEME_ALL, "https://pdfjs.robwu.nl/*"),
+      }));
+  return blocked_patterns->Matches(gurl);
 }
 
 bool IsWhitelistedFingerprintingException(const GURL& firstPartyOrigin,
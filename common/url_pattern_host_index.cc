@@ -0,0 +1,87 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/common/url_pattern_host_index.h"
+
+#include <utility>
+
+#include "base/strings/string_piece.h"
+#include "url/gurl.h"
+
+namespace brave {
+
+namespace {
+
+const size_t kNoMatch = static_cast<size_t>(-1);
+
+}  // namespace
+
+URLPatternHostIndex::URLPatternHostIndex(std::vector<URLPattern> patterns)
+    : patterns_(std::move(patterns)) {
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    const URLPattern& pattern = patterns_[i];
+    if (pattern.host().empty()) {
+      any_host_.push_back(i);
+    } else if (pattern.match_subdomains()) {
+      domains_[pattern.host()].push_back(i);
+    } else {
+      hosts_[pattern.host()].push_back(i);
+    }
+  }
+}
+
+URLPatternHostIndex::~URLPatternHostIndex() = default;
+
+void URLPatternHostIndex::FindMatchIn(const std::vector<size_t>& candidates,
+                                      const GURL& url,
+                                      size_t* best) const {
+  for (size_t index : candidates) {
+    if (index >= *best) {
+      return;
+    }
+    if (patterns_[index].MatchesURL(url)) {
+      *best = index;
+      return;
+    }
+  }
+}
+
+base::Optional<size_t> URLPatternHostIndex::FindMatch(const GURL& url) const {
+  size_t best = kNoMatch;
+  base::StringPiece host = url.host_piece();
+  // URLPattern ignores one trailing dot, so the keys have to as well.
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+
+  auto it = hosts_.find(host);
+  if (it != hosts_.end()) {
+    FindMatchIn(it->second, url, &best);
+  }
+
+  // A subdomain pattern also matches its own domain, so probe the host and
+  // each of its parent domains.
+  if (!domains_.empty()) {
+    while (!host.empty()) {
+      it = domains_.find(host);
+      if (it != domains_.end()) {
+        FindMatchIn(it->second, url, &best);
+      }
+      size_t dot = host.find('.');
+      if (dot == base::StringPiece::npos) {
+        break;
+      }
+      host.remove_prefix(dot + 1);
+    }
+  }
+
+  FindMatchIn(any_host_, url, &best);
+
+  if (best == kNoMatch) {
+    return base::nullopt;
+  }
+  return best;
+}
+
+}  // namespace brave
@@ -0,0 +1,61 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMMON_URL_PATTERN_HOST_INDEX_H_
+#define BRAVE_COMMON_URL_PATTERN_HOST_INDEX_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/macros.h"
+#include "base/optional.h"
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace brave {
+
+// A fixed list of URLPatterns grouped by host, so that a URL is only matched
+// against the patterns which could apply to its host. URLs on an unrelated
+// host cost a lookup per host label and no pattern matching.
+class URLPatternHostIndex {
+ public:
+  explicit URLPatternHostIndex(std::vector<URLPattern> patterns);
+  ~URLPatternHostIndex();
+
+  // Returns the position in the constructor's list of the first pattern that
+  // matches |url|.
+  base::Optional<size_t> FindMatch(const GURL& url) const;
+  bool Matches(const GURL& url) const { return FindMatch(url).has_value(); }
+
+ private:
+  using HostMap =
+      base::flat_map<std::string, std::vector<size_t>, std::less<>>;
+
+  // Matches |candidates|, which are in ascending order, against |url| and
+  // lowers |best| to the first one which matches.
+  void FindMatchIn(const std::vector<size_t>& candidates,
+                   const GURL& url,
+                   size_t* best) const;
+
+  const std::vector<URLPattern> patterns_;
+  // Patterns for an exact host, e.g. "https://brave.com/*".
+  HostMap hosts_;
+  // Patterns for a domain and its subdomains, e.g. "https://*.brave.com/*",
+  // keyed by "brave.com".
+  HostMap domains_;
+  // Patterns matching every host.
+  std::vector<size_t> any_host_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLPatternHostIndex);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_URL_PATTERN_HOST_INDEX_H_
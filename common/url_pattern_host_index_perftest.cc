@@ -0,0 +1,140 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/common/url_pattern_host_index.h"
+
+#include <string>
+#include <vector>
+
+#include "base/optional.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_unit_tests --filter=URLPatternHostIndexPerfTest.* \
+//     --run-manual
+
+namespace {
+
+using brave::URLPatternHostIndex;
+
+const char kMetricPrefixURLPatternHostIndex[] = "URLPatternHostIndex.";
+const char kMetricIndexLookupTime[] = "index_lookup_time";
+const char kMetricLinearLookupTime[] = "linear_lookup_time";
+
+// Hosts of first and third party requests on popular pages
+const char* const kHosts[] = {
+    "google.com", "googleapis.com", "gstatic.com", "doubleclick.net",
+    "facebook.com", "fbcdn.net", "twitter.com", "twimg.com", "youtube.com",
+    "ytimg.com", "amazon.com", "cloudfront.net", "akamaihd.net",
+    "cloudflare.com", "jsdelivr.net", "github.com", "githubusercontent.com",
+    "wikipedia.org", "reddit.com", "redditmedia.com", "nytimes.com",
+    "bbc.co.uk", "cnn.com", "adobe.com", "duckduckgo.com", "brave.com",
+    "netflix.com", "instagram.com", "linkedin.com", "microsoft.com",
+};
+
+// Subdomains and paths the corpus combines with every host
+const char* const kSubdomains[] = {"", "www.", "cdn.", "static.", "api."};
+const char* const kPaths[] = {
+    "/", "/index.html", "/exact/script.js", "/static/app.css",
+    "/api/v1/items?id=42", "/images/logo.png",
+};
+
+// Hosts on none of the patterns, which are most of the requests
+const int kUnrelatedHosts = 200;
+
+std::vector<URLPattern> CreatePatterns() {
+  std::vector<URLPattern> patterns;
+  for (const char* host : kHosts) {
+    patterns.emplace_back(
+        URLPattern::SCHEME_ALL,
+        base::StringPrintf("https://%s/exact/*", host));
+    patterns.emplace_back(
+        URLPattern::SCHEME_ALL,
+        base::StringPrintf("https://*.%s/static/*", host));
+  }
+  return patterns;
+}
+
+std::vector<GURL> CreateCorpus() {
+  std::vector<GURL> corpus;
+  for (const char* host : kHosts) {
+    for (const char* subdomain : kSubdomains) {
+      for (const char* path : kPaths) {
+        corpus.emplace_back(
+            base::StringPrintf("https://%s%s%s", subdomain, host, path));
+      }
+    }
+  }
+  for (int i = 0; i < kUnrelatedHosts; i++) {
+    for (const char* path : kPaths) {
+      corpus.emplace_back(
+          base::StringPrintf("https://site%d.example.org%s", i, path));
+    }
+  }
+  return corpus;
+}
+
+// What matching did before the index: every pattern against every URL
+base::Optional<size_t> FindMatchLinear(
+    const std::vector<URLPattern>& patterns,
+    const GURL& url) {
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    if (patterns[i].MatchesURL(url)) {
+      return i;
+    }
+  }
+  return base::nullopt;
+}
+
+}  // namespace
+
+// Time to match one URL of the corpus with the index and with a linear scan
+// of the same patterns.
+TEST(URLPatternHostIndexPerfTest, MANUAL_IndexVsLinearScan) {
+  const std::vector<URLPattern> patterns = CreatePatterns();
+  const URLPatternHostIndex index(patterns);
+  const std::vector<GURL> corpus = CreateCorpus();
+
+  for (const GURL& url : corpus) {
+    ASSERT_EQ(index.FindMatch(url), FindMatchLinear(patterns, url))
+        << url.spec();
+  }
+
+  perf_test::PerfResultReporter reporter(
+      kMetricPrefixURLPatternHostIndex,
+      base::StringPrintf("%zu_patterns", patterns.size()));
+  reporter.RegisterImportantMetric(kMetricIndexLookupTime, "us");
+  reporter.RegisterImportantMetric(kMetricLinearLookupTime, "us");
+
+  size_t matches = 0;
+  base::LapTimer index_timer;
+  do {
+    for (const GURL& url : corpus) {
+      matches += index.Matches(url);
+    }
+    index_timer.NextLap();
+  } while (!index_timer.HasTimeLimitExpired());
+  reporter.AddResult(
+      kMetricIndexLookupTime,
+      index_timer.TimePerLap() / corpus.size());
+
+  base::LapTimer linear_timer;
+  do {
+    for (const GURL& url : corpus) {
+      matches += FindMatchLinear(patterns, url).has_value();
+    }
+    linear_timer.NextLap();
+  } while (!linear_timer.HasTimeLimitExpired());
+  reporter.AddResult(
+      kMetricLinearLookupTime,
+      linear_timer.TimePerLap() / corpus.size());
+
+  // Keeps the lookups from being optimized away
+  EXPECT_GT(matches, 0u);
+}
@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/common/url_pattern_host_index.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+typedef testing::Test URLPatternHostIndexTest;
+using brave::URLPatternHostIndex;
+
+TEST_F(URLPatternHostIndexTest, ExactAndSubdomainHosts) {
+  URLPatternHostIndex index(std::vector<URLPattern>({
+      URLPattern(URLPattern::SCHEME_ALL, "https://brave.com/exact/*"),
+      URLPattern(URLPattern::SCHEME_ALL, "https://*.brave.com/*"),
+      URLPattern(URLPattern::SCHEME_ALL, "https://*.example.com/path/*"),
+  }));
+
+  EXPECT_EQ(0u, index.FindMatch(GURL("https://brave.com/exact/a")));
+  EXPECT_EQ(1u, index.FindMatch(GURL("https://brave.com/other")));
+  EXPECT_EQ(1u, index.FindMatch(GURL("https://www.brave.com/exact/a")));
+  EXPECT_EQ(1u, index.FindMatch(GURL("https://a.b.brave.com/")));
+  EXPECT_EQ(2u, index.FindMatch(GURL("https://example.com/path/a")));
+  EXPECT_EQ(2u, index.FindMatch(GURL("https://sub.example.com/path/a")));
+
+  EXPECT_FALSE(index.Matches(GURL("http://brave.com/exact/a")));
+  EXPECT_FALSE(index.Matches(GURL("https://notbrave.com/")));
+  EXPECT_FALSE(index.Matches(GURL("https://brave.com.evil.com/")));
+  EXPECT_FALSE(index.Matches(GURL("https://example.com/other")));
+  EXPECT_FALSE(index.Matches(GURL()));
+}
+
+TEST_F(URLPatternHostIndexTest, TrailingDot) {
+  URLPatternHostIndex index(std::vector<URLPattern>({
+      URLPattern(URLPattern::SCHEME_ALL, "https://brave.com/exact/*"),
+      URLPattern(URLPattern::SCHEME_ALL, "https://*.example.com/*"),
+  }));
+
+  EXPECT_EQ(0u, index.FindMatch(GURL("https://brave.com./exact/a")));
+  EXPECT_EQ(1u, index.FindMatch(GURL("https://example.com./")));
+  EXPECT_EQ(1u, index.FindMatch(GURL("https://www.example.com./")));
+
+  EXPECT_FALSE(index.Matches(GURL("https://brave.com../exact/a")));
+  EXPECT_FALSE(index.Matches(GURL("https://brave.com./other")));
+}
+
+TEST_F(URLPatternHostIndexTest, FirstPatternWins) {
+  URLPatternHostIndex index(std::vector<URLPattern>({
+      URLPattern(URLPattern::SCHEME_ALL, "https://*.brave.com/*"),
+      URLPattern(URLPattern::SCHEME_ALL, "https://www.brave.com/*"),
+      URLPattern(URLPattern::SCHEME_ALL, "https://*/any/*"),
+  }));
+
+  EXPECT_EQ(0u, index.FindMatch(GURL("https://www.brave.com/")));
+  EXPECT_EQ(0u, index.FindMatch(GURL("https://www.brave.com/any/")));
+  EXPECT_EQ(2u, index.FindMatch(GURL("https://example.com/any/")));
+  EXPECT_FALSE(index.Matches(GURL("https://example.com/")));
+}
+
+}  // namespace
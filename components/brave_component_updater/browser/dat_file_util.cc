@@ -10,6 +10,7 @@
 #include "base/logging.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/metrics/histogram_macros.h"
 
 namespace brave_component_updater {
 
@@ -44,4 +45,20 @@ std::string GetDATFileAsString(const base::FilePath& file_path) {
   return contents;
 }
 
+bool MapDATFile(const base::FilePath& file_path,
+                base::MemoryMappedFile* mapped_file) {
+  if (!mapped_file->Initialize(file_path) || 0 == mapped_file->length()) {
+    LOG(ERROR) << "MapDATFile: "
+               << "the dat file is not found or corrupted "
+               << file_path;
+    return false;
+  }
+  return true;
+}
+
+void RecordMappedDATFileLoad(base::TimeDelta load_time, size_t mapped_size) {
+  UMA_HISTOGRAM_TIMES("Brave.DATFile.MappedLoadTime", load_time);
+  UMA_HISTOGRAM_MEMORY_KB("Brave.DATFile.MappedSizeKB", mapped_size / 1024);
+}
+
 }  // namespace brave_component_updater
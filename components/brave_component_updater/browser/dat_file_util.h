@@ -12,6 +12,8 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/time/time.h"
 
 namespace brave_component_updater {
 
@@ -20,6 +22,11 @@ using DATFileDataBuffer = std::vector<unsigned char>;
 void GetDATFileData(const base::FilePath& file_path,
                     DATFileDataBuffer* buffer);
 std::string GetDATFileAsString(const base::FilePath& file_path);
+bool MapDATFile(const base::FilePath& file_path,
+                base::MemoryMappedFile* mapped_file);
+// Records how long a mapped DAT file took to map and deserialize, and how
+// large the mapping was.
+void RecordMappedDATFileLoad(base::TimeDelta load_time, size_t mapped_size);
 
 template<typename T>
 using LoadDATFileDataResult =
@@ -41,6 +48,26 @@ LoadDATFileDataResult<T> LoadDATFileData(
       std::move(client), std::move(buffer));
 }
 
+// Like LoadDATFileData, but deserializes straight from a read-only mapping of
+// the file instead of copying it into a heap buffer first. The mapping is
+// released before returning, so only the deserialized client stays resident.
+// Returns nullptr if the file can't be mapped or deserialized.
+template<typename T>
+std::unique_ptr<T> LoadMappedDATFileData(const base::FilePath& dat_file_path) {
+  const base::TimeTicks start = base::TimeTicks::Now();
+  base::MemoryMappedFile mapped_file;
+  if (!MapDATFile(dat_file_path, &mapped_file))
+    return nullptr;
+
+  auto client = std::make_unique<T>();
+  if (!client->deserialize(
+          reinterpret_cast<const char*>(mapped_file.data()),
+          mapped_file.length()))
+    return nullptr;
+  RecordMappedDATFileLoad(base::TimeTicks::Now() - start,
+                          mapped_file.length());
+  return client;
+}
 
 }  // namespace brave_component_updater
 
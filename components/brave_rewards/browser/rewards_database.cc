@@ -157,6 +157,10 @@ void RewardsDatabase::RunTransaction(
         status = Run(command.get());
         break;
       }
+      case ledger::DBCommand::Type::RUN_BATCH: {
+        status = RunBatch(command.get());
+        break;
+      }
       case ledger::DBCommand::Type::MIGRATE: {
         status = Migrate(
             transaction->version,
@@ -253,7 +257,8 @@ ledger::DBCommandResponse::Status RewardsDatabase::Run(
     return ledger::DBCommandResponse::Status::RESPONSE_ERROR;
   }
 
-  sql::Statement statement(db_.GetUniqueStatement(command->command.c_str()));
+  sql::Statement statement;
+  PrepareStatement(*command, &statement);
 
   for (auto const& binding : command->bindings) {
     HandleBinding(&statement, *binding.get());
@@ -271,6 +276,43 @@ ledger::DBCommandResponse::Status RewardsDatabase::Run(
   return ledger::DBCommandResponse::Status::RESPONSE_OK;
 }
 
+ledger::DBCommandResponse::Status RewardsDatabase::RunBatch(
+    ledger::DBCommand* command) {
+  if (!initialized_) {
+    return ledger::DBCommandResponse::Status::INITIALIZATION_ERROR;
+  }
+
+  if (!command) {
+    return ledger::DBCommandResponse::Status::RESPONSE_ERROR;
+  }
+
+  DCHECK(command->bindings.empty());
+
+  // Every row runs through the same prepared statement, inside the
+  // transaction opened by RunTransaction.
+  sql::Statement statement;
+  PrepareStatement(*command, &statement);
+
+  for (auto const& row : command->rows) {
+    statement.Reset(true);
+
+    for (auto const& binding : row->bindings) {
+      HandleBinding(&statement, *binding.get());
+    }
+
+    if (!statement.Run()) {
+      LOG(ERROR) <<
+      "DB Run batch error: " <<
+      db_.GetErrorMessage() <<
+      " (" << db_.GetErrorCode() <<
+      ")";
+      return ledger::DBCommandResponse::Status::COMMAND_ERROR;
+    }
+  }
+
+  return ledger::DBCommandResponse::Status::RESPONSE_OK;
+}
+
 ledger::DBCommandResponse::Status RewardsDatabase::Read(
     ledger::DBCommand* command,
     ledger::DBCommandResponse* command_response) {
@@ -282,8 +324,8 @@ ledger::DBCommandResponse::Status RewardsDatabase::Read(
     return ledger::DBCommandResponse::Status::RESPONSE_ERROR;
   }
 
-  sql::Statement statement(
-      db_.GetUniqueStatement(command->command.c_str()));
+  sql::Statement statement;
+  PrepareStatement(*command, &statement);
 
   for (auto const& binding : command->bindings) {
     HandleBinding(&statement, *binding.get());
@@ -313,6 +355,31 @@ ledger::DBCommandResponse::Status RewardsDatabase::Migrate(
   return ledger::DBCommandResponse::Status::RESPONSE_OK;
 }
 
+void RewardsDatabase::PrepareStatement(
+    const ledger::DBCommand& command,
+    sql::Statement* statement) {
+  DCHECK(statement);
+
+  if (command.statement_id.empty()) {
+    statement->Assign(db_.GetUniqueStatement(command.command.c_str()));
+    return;
+  }
+
+  auto it = statement_ids_.find(command.statement_id);
+  if (it == statement_ids_.end()) {
+    it = statement_ids_.emplace(command.statement_id, command.command).first;
+  } else if (it->second != command.command) {
+    NOTREACHED() << "Statement id " << command.statement_id
+                 << " reused for a different query";
+    statement->Assign(db_.GetUniqueStatement(command.command.c_str()));
+    return;
+  }
+
+  statement->Assign(db_.GetCachedStatement(
+      sql::StatementID(it->first.c_str()),
+      command.command.c_str()));
+}
+
 void RewardsDatabase::OnMemoryPressure(
     base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
@@ -6,7 +6,9 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_REWARDS_DATABASE_H_
 #define BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_REWARDS_DATABASE_H_
 
+#include <map>
 #include <memory>
+#include <string>
 
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
@@ -17,6 +19,10 @@
 #include "sql/init_status.h"
 #include "sql/meta_table.h"
 
+namespace sql {
+class Statement;
+}  // namespace sql
+
 namespace brave_rewards {
 
 class RewardsDatabase {
@@ -39,6 +45,8 @@ class RewardsDatabase {
 
   ledger::DBCommandResponse::Status Run(ledger::DBCommand* command);
 
+  ledger::DBCommandResponse::Status RunBatch(ledger::DBCommand* command);
+
   ledger::DBCommandResponse::Status Read(
       ledger::DBCommand* command,
       ledger::DBCommandResponse* command_response);
@@ -47,10 +55,20 @@ class RewardsDatabase {
       const int32_t version,
       const int32_t compatible_version);
 
+  // Points |statement| at the prepared query of |command|, reusing the cached
+  // one when the command carries a statement id.
+  void PrepareStatement(
+      const ledger::DBCommand& command,
+      sql::Statement* statement);
+
   void OnMemoryPressure(
       base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
 
   const base::FilePath db_path_;
+  // Statement ids seen so far, mapped to their query. sql::StatementID keeps a
+  // pointer to the id string, so the keys must outlive |db_|'s statement
+  // cache.
+  std::map<std::string, std::string> statement_ids_;
   sql::Database db_;
   sql::MetaTable meta_table_;
   bool initialized_;
@@ -0,0 +1,294 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/bind_test_util.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "bat/ledger/internal/database/database_activity_info.h"
+#include "bat/ledger/internal/database/database_initialize.h"
+#include "bat/ledger/internal/database/database_util.h"
+#include "bat/ledger/internal/ledger_client_mock.h"
+#include "bat/ledger/internal/ledger_impl_mock.h"
+#include "brave/components/brave_rewards/browser/rewards_database.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+// npm run test -- brave_unit_tests --filter=RewardsDatabasePerfTest.* \
+//     --run-manual
+
+using ::testing::_;
+using ::testing::Invoke;
+
+namespace brave_rewards {
+
+namespace {
+
+const int kPublisherCount = 50000;
+const int kPageSize = 50;
+// Deep enough that skipping rows by offset dominates the page read
+const int kDeepPage = 200;
+const uint64_t kReconcileStamp = 1000;
+// Older months kept in activity_info next to the current one
+const uint64_t kOlderStamps = 6;
+
+const char kMetricPrefixActivityInfo[] = "ActivityInfo.";
+const char kMetricFirstPageTime[] = "first_page_time";
+const char kMetricOffsetPageTime[] = "offset_page_time";
+const char kMetricSeekPageTime[] = "seek_page_time";
+const char kMetricContributionListTime[] = "contribution_list_time";
+
+}  // namespace
+
+class RewardsDatabasePerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    database_ = std::make_unique<RewardsDatabase>(
+        temp_dir_.GetPath().AppendASCII("publisher_info_db"));
+
+    mock_ledger_client_ = std::make_unique<ledger::MockLedgerClient>();
+    mock_ledger_impl_ =
+        std::make_unique<bat_ledger::MockLedgerImpl>(mock_ledger_client_.get());
+    activity_ =
+        std::make_unique<braveledger_database::DatabaseActivityInfo>(
+            mock_ledger_impl_.get());
+
+    // The ledger talks to the real database, as it does over mojo
+    ON_CALL(*mock_ledger_impl_, RunDBTransaction(_, _))
+        .WillByDefault(
+          Invoke([this](
+              ledger::DBTransactionPtr transaction,
+              ledger::RunDBTransactionCallback callback) {
+            auto response = ledger::DBCommandResponse::New();
+            response->status = ledger::DBCommandResponse::Status::RESPONSE_OK;
+            database_->RunTransaction(std::move(transaction), response.get());
+            callback(std::move(response));
+          }));
+
+    // Runs every migration, so the list reads use the current indexes
+    braveledger_database::DatabaseInitialize initialize(
+        mock_ledger_impl_.get());
+    ledger::Result result = ledger::Result::LEDGER_ERROR;
+    initialize.Start(false, [&result](const ledger::Result init_result) {
+      result = init_result;
+    });
+    ASSERT_EQ(result, ledger::Result::LEDGER_OK);
+
+    SeedPublishers();
+  }
+
+  // Every publisher has activity in the current month and in about half of
+  // the older ones, with spread out percent and duration values
+  void SeedPublishers() {
+    auto publishers = ledger::DBCommand::New();
+    publishers->type = ledger::DBCommand::Type::RUN_BATCH;
+    publishers->command =
+        "INSERT INTO publisher_info "
+        "(publisher_id, excluded, name, favIcon, url, provider) "
+        "VALUES (?, 0, ?, '', '', '')";
+
+    auto server_publishers = ledger::DBCommand::New();
+    server_publishers->type = ledger::DBCommand::Type::RUN_BATCH;
+    server_publishers->command =
+        "INSERT INTO server_publisher_info "
+        "(publisher_key, status, excluded, address) VALUES (?, 2, 0, '')";
+
+    auto activity = ledger::DBCommand::New();
+    activity->type = ledger::DBCommand::Type::RUN_BATCH;
+    activity->command =
+        "INSERT INTO activity_info "
+        "(publisher_id, duration, visits, score, percent, weight, "
+        "reconcile_stamp) VALUES (?, ?, ?, ?, ?, ?, ?)";
+
+    for (int i = 0; i < kPublisherCount; i++) {
+      const std::string key = base::StringPrintf("publisher%06d.com", i);
+      braveledger_database::BindString(publishers.get(), 0, key);
+      braveledger_database::BindString(publishers.get(), 1, key);
+      braveledger_database::EndBatchRow(publishers.get());
+
+      braveledger_database::BindString(server_publishers.get(), 0, key);
+      braveledger_database::EndBatchRow(server_publishers.get());
+
+      for (uint64_t stamp = kReconcileStamp - kOlderStamps;
+           stamp <= kReconcileStamp;
+           stamp++) {
+        if (stamp != kReconcileStamp && (i + stamp) % 2 == 0) {
+          continue;
+        }
+
+        braveledger_database::BindString(activity.get(), 0, key);
+        braveledger_database::BindInt64(activity.get(), 1, (i * 7919) % 5000);
+        braveledger_database::BindInt(activity.get(), 2, 1 + i % 50);
+        braveledger_database::BindDouble(activity.get(), 3, (i % 1000) / 100.0);
+        braveledger_database::BindInt(activity.get(), 4, (i * 37) % 101);
+        braveledger_database::BindDouble(activity.get(), 5, (i % 100) / 100.0);
+        braveledger_database::BindInt64(activity.get(), 6, stamp);
+        braveledger_database::EndBatchRow(activity.get());
+      }
+    }
+
+    auto transaction = ledger::DBTransaction::New();
+    transaction->commands.push_back(std::move(publishers));
+    transaction->commands.push_back(std::move(server_publishers));
+    transaction->commands.push_back(std::move(activity));
+
+    auto command = ledger::DBCommand::New();
+    command->type = ledger::DBCommand::Type::EXECUTE;
+    command->command = "ANALYZE";
+    transaction->commands.push_back(std::move(command));
+
+    ledger::DBCommandResponse response;
+    response.status = ledger::DBCommandResponse::Status::RESPONSE_OK;
+    database_->RunTransaction(std::move(transaction), &response);
+    ASSERT_EQ(response.status, ledger::DBCommandResponse::Status::RESPONSE_OK);
+  }
+
+  // Same filter as the rewards page list, RewardsServiceImpl::
+  // GetContentSiteList
+  ledger::ActivityInfoFilterPtr CreatePageFilter() {
+    auto filter = ledger::ActivityInfoFilter::New();
+    filter->min_duration = 8;
+    filter->order_by.push_back(
+        ledger::ActivityInfoFilterOrderPair::New("ai.percent", false));
+    filter->reconcile_stamp = kReconcileStamp;
+    filter->excluded = ledger::ExcludeFilter::FILTER_ALL_EXCEPT_EXCLUDED;
+    filter->percent = 1;
+    filter->min_visits = 1;
+    return filter;
+  }
+
+  ledger::ActivityInfoFilterPtr CreateContributionFilter() {
+    auto filter = ledger::ActivityInfoFilter::New();
+    filter->min_duration = 8;
+    filter->reconcile_stamp = kReconcileStamp;
+    filter->excluded = ledger::ExcludeFilter::FILTER_ALL_EXCEPT_EXCLUDED;
+    filter->min_visits = 1;
+    return filter;
+  }
+
+  ledger::PublisherInfoList GetRecordsList(
+      const int start,
+      const int limit,
+      ledger::ActivityInfoFilterPtr filter) {
+    ledger::PublisherInfoList list;
+    activity_->GetRecordsList(
+        start,
+        limit,
+        std::move(filter),
+        [&list](ledger::PublisherInfoList result) {
+          list = std::move(result);
+        });
+    return list;
+  }
+
+  // Reports the time of one |read|, checking it returns |rows| rows.
+  void MeasureRead(
+      const std::string& metric,
+      const size_t rows,
+      base::RepeatingCallback<ledger::PublisherInfoList()> read,
+      perf_test::PerfResultReporter* reporter) {
+    base::LapTimer timer(2, base::TimeDelta::FromSeconds(1), 1);
+    do {
+      ASSERT_EQ(read.Run().size(), rows);
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+    reporter->AddResult(metric, timer.TimePerLap());
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<RewardsDatabase> database_;
+  std::unique_ptr<ledger::MockLedgerClient> mock_ledger_client_;
+  std::unique_ptr<bat_ledger::MockLedgerImpl> mock_ledger_impl_;
+  std::unique_ptr<braveledger_database::DatabaseActivityInfo> activity_;
+};
+
+// Page reads of the rewards page list by offset and by seek, and the
+// unordered list read for auto contribute and the normalizer.
+TEST_F(RewardsDatabasePerfTest, MANUAL_GetRecordsList) {
+  perf_test::PerfResultReporter reporter(
+      kMetricPrefixActivityInfo,
+      base::StringPrintf("%d_publishers", kPublisherCount));
+  reporter.RegisterImportantMetric(kMetricFirstPageTime, "ms");
+  reporter.RegisterImportantMetric(kMetricOffsetPageTime, "ms");
+  reporter.RegisterImportantMetric(kMetricSeekPageTime, "ms");
+  reporter.RegisterImportantMetric(kMetricContributionListTime, "ms");
+
+  // A caller which pages by seeking keeps the last row of the previous page
+  const auto previous = GetRecordsList(
+      (kDeepPage - 1) * kPageSize,
+      kPageSize,
+      CreatePageFilter());
+  ASSERT_EQ(previous.size(), static_cast<size_t>(kPageSize));
+  const std::string after_id = previous.back()->id;
+  const double after_value = previous.back()->percent;
+
+  auto create_seek_filter = [this, &after_id, after_value]() {
+    auto filter = CreatePageFilter();
+    filter->after_id = after_id;
+    filter->after_value = after_value;
+    return filter;
+  };
+
+  // Both ways of paging land on the same rows
+  const auto offset_page = GetRecordsList(
+      kDeepPage * kPageSize,
+      kPageSize,
+      CreatePageFilter());
+  const auto seek_page = GetRecordsList(0, kPageSize, create_seek_filter());
+  ASSERT_EQ(offset_page.size(), seek_page.size());
+  for (size_t i = 0; i < offset_page.size(); i++) {
+    EXPECT_EQ(offset_page[i]->id, seek_page[i]->id);
+  }
+
+  MeasureRead(
+      kMetricFirstPageTime,
+      kPageSize,
+      base::BindLambdaForTesting([this]() {
+        return GetRecordsList(0, kPageSize, CreatePageFilter());
+      }),
+      &reporter);
+
+  MeasureRead(
+      kMetricOffsetPageTime,
+      kPageSize,
+      base::BindLambdaForTesting([this]() {
+        return GetRecordsList(
+            kDeepPage * kPageSize,
+            kPageSize,
+            CreatePageFilter());
+      }),
+      &reporter);
+
+  MeasureRead(
+      kMetricSeekPageTime,
+      kPageSize,
+      base::BindLambdaForTesting([this, &create_seek_filter]() {
+        return GetRecordsList(0, kPageSize, create_seek_filter());
+      }),
+      &reporter);
+
+  // Same filter as Publisher::CreateActivityFilter builds for auto
+  // contribute, which reads every row without an order
+  const auto contribution_list =
+      GetRecordsList(0, 0, CreateContributionFilter());
+  ASSERT_FALSE(contribution_list.empty());
+  MeasureRead(
+      kMetricContributionListTime,
+      contribution_list.size(),
+      base::BindLambdaForTesting([this]() {
+        return GetRecordsList(0, 0, CreateContributionFilter());
+      }),
+      &reporter);
+}
+
+}  // namespace brave_rewards
@@ -0,0 +1,220 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/gtest_util.h"
+#include "base/test/task_environment.h"
+#include "bat/ledger/internal/database/database_util.h"
+#include "brave/components/brave_rewards/browser/rewards_database.h"
+#include "sql/test/scoped_error_expecter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/sqlite/sqlite3.h"
+
+// npm run test -- brave_unit_tests --filter=RewardsDatabaseTest.*
+
+namespace brave_rewards {
+
+namespace {
+
+const char kInsertQuery[] = "INSERT INTO test (id, value) VALUES (?, ?)";
+const char kSelectQuery[] = "SELECT id, value FROM test ORDER BY id";
+
+}  // namespace
+
+class RewardsDatabaseTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    database_ = std::make_unique<RewardsDatabase>(
+        temp_dir_.GetPath().AppendASCII("publisher_info_db"));
+
+    auto transaction = ledger::DBTransaction::New();
+    transaction->version = 1;
+    transaction->compatible_version = 1;
+
+    auto command = ledger::DBCommand::New();
+    command->type = ledger::DBCommand::Type::INITIALIZE;
+    transaction->commands.push_back(std::move(command));
+
+    command = ledger::DBCommand::New();
+    command->type = ledger::DBCommand::Type::EXECUTE;
+    command->command =
+        "CREATE TABLE test (id TEXT PRIMARY KEY NOT NULL, value INTEGER)";
+    transaction->commands.push_back(std::move(command));
+
+    ASSERT_EQ(
+        RunTransaction(std::move(transaction)),
+        ledger::DBCommandResponse::Status::RESPONSE_OK);
+  }
+
+  ledger::DBCommandResponse::Status RunTransaction(
+      ledger::DBTransactionPtr transaction) {
+    ledger::DBCommandResponse response;
+    response.status = ledger::DBCommandResponse::Status::RESPONSE_OK;
+    database_->RunTransaction(std::move(transaction), &response);
+    return response.status;
+  }
+
+  ledger::DBCommandResponse::Status RunCommand(ledger::DBCommandPtr command) {
+    auto transaction = ledger::DBTransaction::New();
+    transaction->commands.push_back(std::move(command));
+    return RunTransaction(std::move(transaction));
+  }
+
+  ledger::DBCommandPtr CreateBatchInsert(
+      const std::vector<std::pair<std::string, int>>& rows) {
+    auto command = ledger::DBCommand::New();
+    command->type = ledger::DBCommand::Type::RUN_BATCH;
+    command->command = kInsertQuery;
+    command->statement_id = "test_insert";
+    for (const auto& row : rows) {
+      braveledger_database::BindString(command.get(), 0, row.first);
+      braveledger_database::BindInt(command.get(), 1, row.second);
+      braveledger_database::EndBatchRow(command.get());
+    }
+    return command;
+  }
+
+  ledger::DBCommandPtr CreateInsert(
+      const std::string& statement_id,
+      const std::string& id,
+      const int value) {
+    auto command = ledger::DBCommand::New();
+    command->type = ledger::DBCommand::Type::RUN;
+    command->command = kInsertQuery;
+    command->statement_id = statement_id;
+    braveledger_database::BindString(command.get(), 0, id);
+    braveledger_database::BindInt(command.get(), 1, value);
+    return command;
+  }
+
+  // Returns the rows of the test table as "id=value"
+  std::vector<std::string> ReadRows() {
+    auto command = ledger::DBCommand::New();
+    command->type = ledger::DBCommand::Type::READ;
+    command->command = kSelectQuery;
+    command->statement_id = "test_select";
+    command->record_bindings = {
+        ledger::DBCommand::RecordBindingType::STRING_TYPE,
+        ledger::DBCommand::RecordBindingType::INT_TYPE
+    };
+
+    auto transaction = ledger::DBTransaction::New();
+    transaction->commands.push_back(std::move(command));
+
+    ledger::DBCommandResponse response;
+    response.status = ledger::DBCommandResponse::Status::RESPONSE_OK;
+    database_->RunTransaction(std::move(transaction), &response);
+
+    std::vector<std::string> rows;
+    if (response.status != ledger::DBCommandResponse::Status::RESPONSE_OK ||
+        !response.result) {
+      return rows;
+    }
+
+    for (const auto& record : response.result->get_records()) {
+      rows.push_back(
+          record->fields[0]->get_string_value() + "=" +
+          std::to_string(record->fields[1]->get_int_value()));
+    }
+    return rows;
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<RewardsDatabase> database_;
+};
+
+TEST_F(RewardsDatabaseTest, RunBatchInsertsEveryRow) {
+  EXPECT_EQ(
+      RunCommand(CreateBatchInsert({{"a", 1}, {"b", 2}, {"c", 3}})),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+
+  EXPECT_EQ(ReadRows(), std::vector<std::string>({"a=1", "b=2", "c=3"}));
+}
+
+TEST_F(RewardsDatabaseTest, RunBatchRollsBackOnFailingRow) {
+  auto transaction = ledger::DBTransaction::New();
+
+  auto command = ledger::DBCommand::New();
+  command->type = ledger::DBCommand::Type::EXECUTE;
+  command->command = "INSERT INTO test (id, value) VALUES ('z', 0)";
+  transaction->commands.push_back(std::move(command));
+
+  // The duplicate key fails the third row, after two rows were written
+  transaction->commands.push_back(
+      CreateBatchInsert({{"a", 1}, {"b", 2}, {"a", 3}, {"c", 4}}));
+
+  {
+    sql::test::ScopedErrorExpecter expecter;
+    expecter.ExpectError(SQLITE_CONSTRAINT);
+    EXPECT_EQ(
+        RunTransaction(std::move(transaction)),
+        ledger::DBCommandResponse::Status::COMMAND_ERROR);
+    EXPECT_TRUE(expecter.SawExpectedErrors());
+  }
+
+  // Nothing from the transaction is kept
+  EXPECT_TRUE(ReadRows().empty());
+
+  // The cached statement is still usable after the failed run
+  EXPECT_EQ(
+      RunCommand(CreateBatchInsert({{"a", 1}, {"b", 2}})),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+  EXPECT_EQ(ReadRows(), std::vector<std::string>({"a=1", "b=2"}));
+}
+
+TEST_F(RewardsDatabaseTest, CachedStatementIsReused) {
+  EXPECT_EQ(
+      RunCommand(CreateInsert("test_insert", "a", 1)),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+  EXPECT_EQ(ReadRows(), std::vector<std::string>({"a=1"}));
+
+  // The same ids get the statements prepared above, which have to come back
+  // reset, with the new bindings and fresh results
+  EXPECT_EQ(
+      RunCommand(CreateInsert("test_insert", "b", 2)),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+  EXPECT_EQ(
+      RunCommand(CreateBatchInsert({{"c", 3}})),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+  EXPECT_EQ(ReadRows(), std::vector<std::string>({"a=1", "b=2", "c=3"}));
+}
+
+TEST_F(RewardsDatabaseTest, StatementIdReusedForDifferentQuery) {
+  EXPECT_EQ(
+      RunCommand(CreateInsert("test_statement", "a", 1)),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+
+  auto command = ledger::DBCommand::New();
+  command->type = ledger::DBCommand::Type::RUN;
+  command->command = "UPDATE test SET value = ? WHERE id = ?";
+  command->statement_id = "test_statement";
+  braveledger_database::BindInt(command.get(), 0, 5);
+  braveledger_database::BindString(command.get(), 1, "a");
+
+#if DCHECK_IS_ON()
+  EXPECT_DCHECK_DEATH(RunCommand(std::move(command)));
+#else
+  // Release builds fall back to a statement of its own
+  EXPECT_EQ(
+      RunCommand(std::move(command)),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+  EXPECT_EQ(ReadRows(), std::vector<std::string>({"a=5"}));
+
+  // The id still prepares the query it was first used with
+  EXPECT_EQ(
+      RunCommand(CreateInsert("test_statement", "b", 2)),
+      ledger::DBCommandResponse::Status::RESPONSE_OK);
+  EXPECT_EQ(ReadRows(), std::vector<std::string>({"a=5", "b=2"}));
+#endif
+}
+
+}  // namespace brave_rewards
@@ -58,6 +58,10 @@ void RewardsService::RegisterProfilePrefs(PrefRegistrySimple* registry) {
   registry->RegisterBooleanPref(prefs::kBraveRewardsEnabled, false);
   registry->RegisterDictionaryPref(prefs::kRewardsExternalWallets);
   registry->RegisterUint64Pref(prefs::kStateServerPublisherListStamp, 0ull);
+  registry->RegisterStringPref(prefs::kStateServerPublisherListETags, "");
+  registry->RegisterUint64Pref(
+      prefs::kStateServerPublisherListGeneration,
+      0ull);
   registry->RegisterStringPref(prefs::kStateUpholdAnonAddress, "");
   registry->RegisterStringPref(prefs::kRewardsBadgeText, "1");
 #if defined(OS_ANDROID)
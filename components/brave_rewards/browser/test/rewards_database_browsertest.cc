@@ -4,8 +4,11 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "base/path_service.h"
+#include "base/run_loop.h"
 #include "base/strings/string_split.h"
 #include "base/strings/stringprintf.h"
+#include "base/test/test_timeouts.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "bat/ledger/internal/database/database_util.h"
 #include "bat/ledger/mojom_structs.h"
 #include "brave/browser/brave_rewards/rewards_service_factory.h"
@@ -234,6 +237,24 @@ class RewardsDatabaseBrowserTest : public InProcessBrowserTest {
     return static_cast<int>(s.ColumnInt64(0));
   }
 
+  // Ledger writes through its own connection, so poll until |query| counts
+  // |expected| rows
+  void WaitForRowCount(const std::string& query, const int32_t expected) {
+    while (true) {
+      sql::Statement s(db_.GetUniqueStatement(query.c_str()));
+      if (s.Step() && s.ColumnInt64(0) == expected) {
+        return;
+      }
+
+      base::RunLoop run_loop;
+      base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+          FROM_HERE,
+          run_loop.QuitClosure(),
+          TestTimeouts::tiny_timeout());
+      run_loop.Run();
+    }
+  }
+
   int32_t GetTableVersionNumber() {
     return meta_table_.GetVersionNumber();
   }
@@ -931,4 +952,91 @@ IN_PROC_BROWSER_TEST_F(
   }
 }
 
+IN_PROC_BROWSER_TEST_F(
+    RewardsDatabaseBrowserTest,
+    Migration_28_ServerPublisherInfo) {
+  {
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    InitDB();
+    rewards_browsertest_util::EnableRewardsViaCode(browser(), rewards_service_);
+
+    EXPECT_TRUE(db_.DoesColumnExist("server_publisher_info", "page"));
+    EXPECT_TRUE(db_.DoesColumnExist("server_publisher_info", "refresh_generation"));
+    EXPECT_TRUE(db_.DoesIndexExist("server_publisher_info_page_index"));
+
+    // Rows from before the migration are on page 0 until the refresh,
+    // which starts right away, sweeps them
+    WaitForRowCount(
+        "SELECT COUNT(*) FROM server_publisher_info WHERE page = 0",
+        0);
+
+    // Every publisher from the mocked list is on the only page
+    WaitForRowCount(
+        "SELECT COUNT(*) FROM server_publisher_info "
+        "WHERE page = 1 AND refresh_generation > 0",
+        8);
+
+    const std::string query =
+        "SELECT address FROM server_publisher_info "
+        "WHERE publisher_key = 'duckduckgo.com'";
+    sql::Statement sql(db_.GetUniqueStatement(query.c_str()));
+    ASSERT_TRUE(sql.Step());
+    EXPECT_EQ(sql.ColumnString(0), "address2");
+
+    // stale.com is not on the list, so its row and banner data are gone
+    EXPECT_EQ(CountTableRows("server_publisher_info"), 8);
+    for (const auto* table : {
+        "server_publisher_banner",
+        "server_publisher_links",
+        "server_publisher_amounts"}) {
+      const std::string stale_query = base::StringPrintf(
+          "SELECT COUNT(*) FROM %s WHERE publisher_key = 'stale.com'",
+          table);
+      sql::Statement stale_sql(db_.GetUniqueStatement(stale_query.c_str()));
+      ASSERT_TRUE(stale_sql.Step());
+      EXPECT_EQ(stale_sql.ColumnInt(0), 0) << table;
+    }
+  }
+}
+
+IN_PROC_BROWSER_TEST_F(
+    RewardsDatabaseBrowserTest,
+    Migration_29_ActivityInfo) {
+  {
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    InitDB();
+    rewards_browsertest_util::EnableRewardsViaCode(browser(), rewards_service_);
+
+    EXPECT_TRUE(db_.DoesIndexExist(
+        "activity_info_reconcile_stamp_percent_index"));
+    EXPECT_TRUE(db_.DoesIndexExist(
+        "activity_info_reconcile_stamp_publisher_id_index"));
+
+    EXPECT_EQ(CountTableRows("activity_info"), 3);
+
+    const std::string query =
+        "SELECT publisher_id, duration, visits, percent FROM activity_info "
+        "WHERE reconcile_stamp = 1593000000 ORDER BY percent DESC";
+    sql::Statement sql(db_.GetUniqueStatement(query.c_str()));
+
+    ledger::PublisherInfoList list;
+    while (sql.Step()) {
+      auto info = ledger::PublisherInfo::New();
+      info->id = sql.ColumnString(0);
+      info->duration = sql.ColumnInt64(1);
+      info->visits = sql.ColumnInt(2);
+      info->percent = sql.ColumnInt(3);
+      list.push_back(std::move(info));
+    }
+
+    ASSERT_EQ(list.size(), 2u);
+    EXPECT_EQ(list.at(0)->id, "brave.com");
+    EXPECT_EQ(list.at(0)->duration, 120u);
+    EXPECT_EQ(list.at(0)->visits, 4u);
+    EXPECT_EQ(list.at(0)->percent, 65u);
+    EXPECT_EQ(list.at(1)->id, "duckduckgo.com");
+    EXPECT_EQ(list.at(1)->percent, 35u);
+  }
+}
+
 }  // namespace rewards_browsertest
@@ -24,6 +24,8 @@ extern const char kRewardsBadgeText[];
 
 // Defined in native-ledger
 extern const char kStateServerPublisherListStamp[];
+extern const char kStateServerPublisherListETags[];
+extern const char kStateServerPublisherListGeneration[];
 extern const char kStateUpholdAnonAddress[];
 extern const char kStatePromotionLastFetchStamp[];
 extern const char kStatePromotionCorruptedMigrated[];
@@ -0,0 +1,155 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
+
+#include <unordered_set>
+#include <utility>
+
+#include "base/json/json_reader.h"
+
+namespace brave_shields {
+
+namespace {
+
+void AppendStrings(const base::Value* list, std::vector<std::string>* out) {
+  if (!list || !list->is_list()) {
+    return;
+  }
+  out->reserve(out->size() + list->GetList().size());
+  for (const auto& item : list->GetList()) {
+    if (item.is_string()) {
+      out->push_back(item.GetString());
+    }
+  }
+}
+
+base::Value ToListValue(const std::vector<std::string>& strings) {
+  base::Value list(base::Value::Type::LIST);
+  for (const auto& item : strings) {
+    list.Append(item);
+  }
+  return list;
+}
+
+}  // namespace
+
+CosmeticResources::CosmeticResources() = default;
+CosmeticResources::CosmeticResources(CosmeticResources&&) = default;
+CosmeticResources& CosmeticResources::operator=(CosmeticResources&&) = default;
+CosmeticResources::~CosmeticResources() = default;
+
+// static
+base::Optional<CosmeticResources> CosmeticResources::FromJSON(
+    base::StringPiece json) {
+  base::Optional<base::Value> value = base::JSONReader::Read(json);
+  if (!value || !value->is_dict()) {
+    return base::nullopt;
+  }
+
+  CosmeticResources resources;
+  AppendStrings(value->FindListKey("hide_selectors"),
+                &resources.hide_selectors);
+  AppendStrings(value->FindListKey("exceptions"), &resources.exceptions);
+  AppendStrings(value->FindListKey("force_hide_selectors"),
+                &resources.force_hide_selectors);
+
+  const base::Value* style_selectors = value->FindDictKey("style_selectors");
+  if (style_selectors) {
+    std::vector<std::pair<std::string, std::vector<std::string>>> styles;
+    for (const auto& item : style_selectors->DictItems()) {
+      std::vector<std::string> rules;
+      if (item.second.is_string()) {
+        rules.push_back(item.second.GetString());
+      } else {
+        AppendStrings(&item.second, &rules);
+      }
+      styles.emplace_back(item.first, std::move(rules));
+    }
+    // Dictionary items are already sorted, so this doesn't re-sort.
+    resources.style_selectors =
+        base::flat_map<std::string, std::vector<std::string>>(
+            std::move(styles));
+  }
+
+  const std::string* injected_script = value->FindStringKey("injected_script");
+  if (injected_script) {
+    resources.injected_script = *injected_script;
+  }
+  resources.generichide = value->FindBoolKey("generichide").value_or(false);
+
+  return resources;
+}
+
+void CosmeticResources::MergeFrom(CosmeticResources from, bool force_hide) {
+  MergeCosmeticSelectors(force_hide ? &force_hide_selectors : &hide_selectors,
+                         std::move(from.hide_selectors));
+  MergeCosmeticSelectors(&force_hide_selectors,
+                         std::move(from.force_hide_selectors));
+  MergeCosmeticSelectors(&exceptions, std::move(from.exceptions));
+
+  for (auto& item : from.style_selectors) {
+    auto it = style_selectors.find(item.first);
+    if (it == style_selectors.end()) {
+      style_selectors.emplace(item.first, std::move(item.second));
+    } else {
+      MergeCosmeticSelectors(&it->second, std::move(item.second));
+    }
+  }
+
+  if (!from.injected_script.empty()) {
+    if (!injected_script.empty()) {
+      injected_script += '\n';
+    }
+    injected_script += from.injected_script;
+  }
+
+  generichide = generichide || from.generichide;
+}
+
+base::Value CosmeticResources::ToValue() const {
+  base::Value styles(base::Value::Type::DICTIONARY);
+  for (const auto& item : style_selectors) {
+    styles.SetKey(item.first, ToListValue(item.second));
+  }
+
+  base::Value value(base::Value::Type::DICTIONARY);
+  value.SetKey("hide_selectors", ToListValue(hide_selectors));
+  value.SetKey("style_selectors", std::move(styles));
+  value.SetKey("exceptions", ToListValue(exceptions));
+  value.SetStringKey("injected_script", injected_script);
+  value.SetBoolKey("generichide", generichide);
+  value.SetKey("force_hide_selectors", ToListValue(force_hide_selectors));
+  return value;
+}
+
+std::vector<std::string> ParseCosmeticSelectors(base::StringPiece json) {
+  std::vector<std::string> selectors;
+  base::Optional<base::Value> value = base::JSONReader::Read(json);
+  if (value) {
+    AppendStrings(&*value, &selectors);
+  }
+  return selectors;
+}
+
+void MergeCosmeticSelectors(std::vector<std::string>* into,
+                            std::vector<std::string> from) {
+  if (from.empty()) {
+    return;
+  }
+  // Reserve up front so the pieces in |seen| keep pointing at live strings.
+  into->reserve(into->size() + from.size());
+  std::unordered_set<base::StringPiece, base::StringPieceHash> seen(
+      into->begin(), into->end());
+  for (auto& selector : from) {
+    if (seen.find(selector) != seen.end()) {
+      continue;
+    }
+    into->push_back(std::move(selector));
+    seen.insert(into->back());
+  }
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,57 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_H_
+
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/optional.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace brave_shields {
+
+// Typed form of the UrlCosmeticResources object returned by an adblock
+// engine. Results of several engines are merged in this form and only
+// converted to a base::Value once, when handed to the extension.
+struct CosmeticResources {
+  CosmeticResources();
+  CosmeticResources(CosmeticResources&&);
+  CosmeticResources& operator=(CosmeticResources&&);
+  ~CosmeticResources();
+
+  // Returns nullopt if |json| is not a UrlCosmeticResources object.
+  static base::Optional<CosmeticResources> FromJSON(base::StringPiece json);
+
+  // Merges |from| into this one, skipping selectors and exceptions which are
+  // already present. If |force_hide| is true, `from.hide_selectors` are
+  // merged into `force_hide_selectors` instead of `hide_selectors`.
+  void MergeFrom(CosmeticResources from, bool force_hide);
+
+  base::Value ToValue() const;
+
+  std::vector<std::string> hide_selectors;
+  base::flat_map<std::string, std::vector<std::string>> style_selectors;
+  std::vector<std::string> exceptions;
+  std::string injected_script;
+  bool generichide = false;
+  std::vector<std::string> force_hide_selectors;
+};
+
+// Parses the selector list returned by adblock::Engine::hiddenClassIdSelectors.
+// Returns an empty list if |json| is not a list.
+std::vector<std::string> ParseCosmeticSelectors(base::StringPiece json);
+
+// Appends the entries of |from| which are not already in |into|, keeping the
+// order in which they first appear.
+void MergeCosmeticSelectors(std::vector<std::string>* into,
+                            std::vector<std::string> from);
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_H_
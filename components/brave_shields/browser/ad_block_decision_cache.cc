@@ -0,0 +1,74 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+
+#include "base/no_destructor.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+
+namespace brave_shields {
+
+namespace {
+
+const size_t kDefaultCacheSize = 2000;
+
+std::string MakeKey(const std::string& url_spec,
+                    const std::string& tab_host,
+                    blink::mojom::ResourceType resource_type) {
+  return base::StrCat({tab_host, " ",
+                       base::NumberToString(static_cast<int>(resource_type)),
+                       " ", url_spec});
+}
+
+}  // namespace
+
+AdBlockDecisionCache::AdBlockDecisionCache(size_t size) : entries_(size) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+AdBlockDecisionCache::~AdBlockDecisionCache() = default;
+
+// static
+AdBlockDecisionCache* AdBlockDecisionCache::GetInstance() {
+  static base::NoDestructor<AdBlockDecisionCache> instance(kDefaultCacheSize);
+  return instance.get();
+}
+
+void AdBlockDecisionCache::Invalidate() {
+  generation_++;
+}
+
+bool AdBlockDecisionCache::Get(const std::string& url_spec,
+                               const std::string& tab_host,
+                               blink::mojom::ResourceType resource_type,
+                               Decision* decision) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = entries_.Get(MakeKey(url_spec, tab_host, resource_type));
+  if (it == entries_.end()) {
+    return false;
+  }
+  if (it->second.generation != generation()) {
+    entries_.Erase(it);
+    return false;
+  }
+  *decision = it->second.decision;
+  return true;
+}
+
+void AdBlockDecisionCache::Put(const std::string& url_spec,
+                               const std::string& tab_host,
+                               blink::mojom::ResourceType resource_type,
+                               uint64_t generation,
+                               const Decision& decision) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (generation != this->generation()) {
+    return;
+  }
+  entries_.Put(MakeKey(url_spec, tab_host, resource_type),
+               Entry{generation, decision});
+}
+
+}  // namespace brave_shields
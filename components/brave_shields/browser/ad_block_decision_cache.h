@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/sequence_checker.h"
+#include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
+
+namespace brave_shields {
+
+// Remembers recent ad-block decisions so that a request seen before can be
+// answered synchronously without a trip to the ad-block task runner.
+//
+// Every entry is stamped with the generation the decision was computed under.
+// Any change to an engine (new list, tags, resources, enabled lists) calls
+// Invalidate(), which may happen on any thread and makes all older entries
+// misses. Lookups and insertions must happen on a single sequence.
+class AdBlockDecisionCache {
+ public:
+  struct Decision {
+    bool blocked = false;
+    bool cancel_request_explicitly = false;
+    std::string mock_data_url;
+  };
+
+  explicit AdBlockDecisionCache(size_t size);
+  ~AdBlockDecisionCache();
+
+  static AdBlockDecisionCache* GetInstance();
+
+  void Invalidate();
+  uint64_t generation() const { return generation_.load(); }
+
+  bool Get(const std::string& url_spec,
+           const std::string& tab_host,
+           blink::mojom::ResourceType resource_type,
+           Decision* decision);
+  // Drops |decision| if the engines changed after |generation| was read.
+  void Put(const std::string& url_spec,
+           const std::string& tab_host,
+           blink::mojom::ResourceType resource_type,
+           uint64_t generation,
+           const Decision& decision);
+
+ private:
+  struct Entry {
+    uint64_t generation;
+    Decision decision;
+  };
+
+  std::atomic<uint64_t> generation_{0};
+  base::HashingMRUCache<std::string, Entry> entries_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  DISALLOW_COPY_AND_ASSIGN(AdBlockDecisionCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
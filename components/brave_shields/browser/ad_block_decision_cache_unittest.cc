@@ -0,0 +1,60 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::AdBlockDecisionCache;
+
+namespace {
+
+const char kURL[] = "https://tracker.example.com/pixel.gif";
+const char kTabHost[] = "brave.com";
+
+}  // namespace
+
+TEST(AdBlockDecisionCacheTest, GetAndPut) {
+  AdBlockDecisionCache cache(10);
+  AdBlockDecisionCache::Decision decision;
+  EXPECT_FALSE(cache.Get(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+                         &decision));
+
+  AdBlockDecisionCache::Decision blocked;
+  blocked.blocked = true;
+  blocked.mock_data_url = "data:image/gif;base64,";
+  cache.Put(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+            cache.generation(), blocked);
+  ASSERT_TRUE(cache.Get(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+                        &decision));
+  EXPECT_TRUE(decision.blocked);
+  EXPECT_EQ(decision.mock_data_url, blocked.mock_data_url);
+
+  // The tab host and resource type are part of the key.
+  EXPECT_FALSE(cache.Get(kURL, "example.com",
+                         blink::mojom::ResourceType::kImage, &decision));
+  EXPECT_FALSE(cache.Get(kURL, kTabHost, blink::mojom::ResourceType::kScript,
+                         &decision));
+}
+
+TEST(AdBlockDecisionCacheTest, Invalidate) {
+  AdBlockDecisionCache cache(10);
+  AdBlockDecisionCache::Decision decision;
+  cache.Put(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+            cache.generation(), AdBlockDecisionCache::Decision());
+  EXPECT_TRUE(cache.Get(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+                        &decision));
+
+  cache.Invalidate();
+  EXPECT_FALSE(cache.Get(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+                         &decision));
+
+  // Decisions computed before an invalidation are dropped.
+  const uint64_t stale_generation = cache.generation();
+  cache.Invalidate();
+  cache.Put(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+            stale_generation, AdBlockDecisionCache::Decision());
+  EXPECT_FALSE(cache.Get(kURL, kTabHost, blink::mojom::ResourceType::kImage,
+                         &decision));
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
+
+#include <utility>
+
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
+
+namespace brave_shields {
+
+AdBlockEngine::AdBlockEngine(std::unique_ptr<adblock::Engine> engine)
+    : engine_(std::move(engine)) {
+  DCHECK(engine_);
+}
+
+AdBlockEngine::~AdBlockEngine() = default;
+
+bool AdBlockEngine::ShouldStartRequest(const AdBlockRequest& request,
+                                       bool* did_match_exception,
+                                       bool* cancel_request_explicitly,
+                                       std::string* mock_data_url) const {
+  bool explicit_cancel;
+  bool saved_from_exception;
+  if (engine_->matches(request.spec, request.host, request.tab_host,
+                       request.is_third_party, request.resource_type,
+                       &explicit_cancel, &saved_from_exception,
+                       mock_data_url)) {
+    if (cancel_request_explicitly) {
+      *cancel_request_explicitly = explicit_cancel;
+    }
+    // We'd only possibly match an exception filter if we're returning true.
+    if (did_match_exception) {
+      *did_match_exception = false;
+    }
+    return false;
+  }
+
+  if (did_match_exception) {
+    *did_match_exception = saved_from_exception;
+  }
+
+  return true;
+}
+
+base::Optional<CosmeticResources> AdBlockEngine::UrlCosmeticResources(
+    const std::string& url) const {
+  return CosmeticResources::FromJSON(engine_->urlCosmeticResources(url));
+}
+
+std::vector<std::string> AdBlockEngine::HiddenClassIdSelectors(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) const {
+  return ParseCosmeticSelectors(
+      engine_->hiddenClassIdSelectors(classes, ids, exceptions));
+}
+
+void AdBlockEngine::AddTag(const std::string& tag) {
+  engine_->addTag(tag);
+}
+
+void AdBlockEngine::RemoveTag(const std::string& tag) {
+  engine_->removeTag(tag);
+}
+
+void AdBlockEngine::AddResources(const std::string& resources) {
+  engine_->addResources(resources);
+}
+
+AdBlockEngineHandle::AdBlockEngineHandle() = default;
+
+AdBlockEngineHandle::~AdBlockEngineHandle() = default;
+
+scoped_refptr<AdBlockEngine> AdBlockEngineHandle::Get() const {
+  base::AutoLock lock(lock_);
+  return engine_;
+}
+
+void AdBlockEngineHandle::Publish(scoped_refptr<AdBlockEngine> engine) {
+  scoped_refptr<AdBlockEngine> old_engine;
+  {
+    base::AutoLock lock(lock_);
+    old_engine = std::move(engine_);
+    engine_ = std::move(engine);
+  }
+  // |old_engine| is released outside the lock; it is destroyed here unless a
+  // reader still holds it, in which case the reader drops the last reference.
+}
+
+}  // namespace brave_shields
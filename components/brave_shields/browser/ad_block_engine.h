@@ -0,0 +1,86 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/optional.h"
+#include "base/synchronization/lock.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
+
+namespace adblock {
+class Engine;
+}  // namespace adblock
+
+namespace brave_shields {
+
+struct AdBlockRequest;
+
+// A ref-counted adblock::Engine. Readers on any thread hold a reference for
+// the duration of a query, so a new engine can be published while queries
+// against the previous one are still running.
+class AdBlockEngine : public base::RefCountedThreadSafe<AdBlockEngine> {
+ public:
+  explicit AdBlockEngine(std::unique_ptr<adblock::Engine> engine);
+
+  // Returns false if the request should be blocked. See
+  // BaseBraveShieldsService::ShouldStartRequest.
+  bool ShouldStartRequest(const AdBlockRequest& request,
+                          bool* did_match_exception,
+                          bool* cancel_request_explicitly,
+                          std::string* mock_data_url) const;
+  base::Optional<CosmeticResources> UrlCosmeticResources(
+      const std::string& url) const;
+  std::vector<std::string> HiddenClassIdSelectors(
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions) const;
+
+  // Tags and resources are the only state changed after an engine has been
+  // published. They are updated on the owning service's task runner, which
+  // is also where every query runs.
+  void AddTag(const std::string& tag);
+  void RemoveTag(const std::string& tag);
+  void AddResources(const std::string& resources);
+
+ private:
+  friend class base::RefCountedThreadSafe<AdBlockEngine>;
+  ~AdBlockEngine();
+
+  const std::unique_ptr<adblock::Engine> engine_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockEngine);
+};
+
+// Stable handle to whichever AdBlockEngine a service currently uses. Owners
+// replace the engine with Publish(); readers take a snapshot with Get(). The
+// lock only guards the pointer copy, never a query.
+class AdBlockEngineHandle
+    : public base::RefCountedThreadSafe<AdBlockEngineHandle> {
+ public:
+  AdBlockEngineHandle();
+
+  scoped_refptr<AdBlockEngine> Get() const;
+  void Publish(scoped_refptr<AdBlockEngine> engine);
+
+ private:
+  friend class base::RefCountedThreadSafe<AdBlockEngineHandle>;
+  ~AdBlockEngineHandle();
+
+  mutable base::Lock lock_;
+  scoped_refptr<AdBlockEngine> engine_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockEngineHandle);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_H_
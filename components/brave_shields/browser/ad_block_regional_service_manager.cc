@@ -14,7 +14,10 @@
 #include "base/values.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/pref_names.h"
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
@@ -30,7 +33,8 @@ namespace brave_shields {
 AdBlockRegionalServiceManager::AdBlockRegionalServiceManager(
     brave_component_updater::BraveComponent::Delegate* delegate)
     : delegate_(delegate),
-      initialized_(false) {
+      initialized_(false),
+      engine_handles_(base::MakeRefCounted<EngineHandles>()) {
   if (Init()) {
     initialized_ = true;
   }
@@ -87,6 +91,23 @@ void AdBlockRegionalServiceManager::StartRegionalServices() {
           std::make_pair(uuid, std::move(regional_service)));
     }
   }
+  UpdateEngineHandlesLocked();
+}
+
+void AdBlockRegionalServiceManager::UpdateEngineHandlesLocked() {
+  regional_services_lock_.AssertAcquired();
+  auto engine_handles = base::MakeRefCounted<EngineHandles>();
+  for (const auto& regional_service : regional_services_) {
+    engine_handles->data.push_back(regional_service.second->engine_handle());
+  }
+  base::AutoLock lock(engine_handles_lock_);
+  engine_handles_ = std::move(engine_handles);
+}
+
+scoped_refptr<AdBlockRegionalServiceManager::EngineHandles>
+AdBlockRegionalServiceManager::GetEngineHandles() const {
+  base::AutoLock lock(engine_handles_lock_);
+  return engine_handles_;
 }
 
 void AdBlockRegionalServiceManager::UpdateFilterListPrefs(
@@ -130,11 +151,25 @@ bool AdBlockRegionalServiceManager::ShouldStartRequest(
     bool* matching_exception_filter,
     bool* cancel_request_explicitly,
     std::string* mock_data_url) {
-  base::AutoLock lock(regional_services_lock_);
-  for (const auto& regional_service : regional_services_) {
-    if (!regional_service.second->ShouldStartRequest(
-            url, resource_type, tab_host, matching_exception_filter,
-            cancel_request_explicitly, mock_data_url)) {
+  return ShouldStartRequest(AdBlockRequest(url, resource_type, tab_host),
+                            matching_exception_filter,
+                            cancel_request_explicitly, mock_data_url);
+}
+
+bool AdBlockRegionalServiceManager::ShouldStartRequest(
+    const AdBlockRequest& request,
+    bool* matching_exception_filter,
+    bool* cancel_request_explicitly,
+    std::string* mock_data_url) {
+  scoped_refptr<EngineHandles> engine_handles = GetEngineHandles();
+  for (const auto& engine_handle : engine_handles->data) {
+    scoped_refptr<AdBlockEngine> engine = engine_handle->Get();
+    if (!engine) {
+      continue;
+    }
+    if (!engine->ShouldStartRequest(request, matching_exception_filter,
+                                    cancel_request_explicitly,
+                                    mock_data_url)) {
       return false;
     }
     if (matching_exception_filter && *matching_exception_filter) {
@@ -181,7 +216,9 @@ void AdBlockRegionalServiceManager::EnableFilterList(const std::string& uuid,
       it->second->Unregister();
       regional_services_.erase(it);
     }
+    UpdateEngineHandlesLocked();
   }
+  AdBlockDecisionCache::GetInstance()->Invalidate();
 
   // Update preferences to reflect enabled/disabled state of specified
   // filter list
@@ -191,60 +228,48 @@ void AdBlockRegionalServiceManager::EnableFilterList(const std::string& uuid,
                      base::Unretained(this), uuid, enabled));
 }
 
-base::Optional<base::Value>
+base::Optional<CosmeticResources>
 AdBlockRegionalServiceManager::UrlCosmeticResources(
         const std::string& url) {
-  auto it = this->regional_services_.begin();
-  if (it == this->regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->UrlCosmeticResources(url);
-
-  for ( ; it != this->regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->UrlCosmeticResources(url);
-    if (first_value) {
-      if (next_value) {
-        MergeResourcesInto(&*first_value, &*next_value, false);
-      }
+  base::Optional<CosmeticResources> resources;
+  scoped_refptr<EngineHandles> engine_handles = GetEngineHandles();
+  for (const auto& engine_handle : engine_handles->data) {
+    scoped_refptr<AdBlockEngine> engine = engine_handle->Get();
+    if (!engine) {
+      continue;
+    }
+    base::Optional<CosmeticResources> next_resources =
+        engine->UrlCosmeticResources(url);
+    if (!next_resources) {
+      continue;
+    }
+    if (resources) {
+      resources->MergeFrom(std::move(*next_resources), false);
     } else {
-      first_value = std::move(next_value);
+      resources = std::move(next_resources);
     }
   }
 
-  return first_value;
+  return resources;
 }
 
-base::Optional<base::Value>
+std::vector<std::string>
 AdBlockRegionalServiceManager::HiddenClassIdSelectors(
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
-  auto it = this->regional_services_.begin();
-  if (it == this->regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-
-  for ( ; it != this->regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-    if (first_value && first_value->is_list()) {
-      if (next_value && next_value->is_list()) {
-        for (auto i = next_value->GetList().begin();
-                i < next_value->GetList().end();
-                i++) {
-          first_value->Append(std::move(*i));
-        }
-      }
-    } else {
-      first_value = std::move(next_value);
+  std::vector<std::string> selectors;
+  scoped_refptr<EngineHandles> engine_handles = GetEngineHandles();
+  for (const auto& engine_handle : engine_handles->data) {
+    scoped_refptr<AdBlockEngine> engine = engine_handle->Get();
+    if (!engine) {
+      continue;
     }
+    MergeCosmeticSelectors(
+        &selectors, engine->HiddenClassIdSelectors(classes, ids, exceptions));
   }
 
-  return first_value;
+  return selectors;
 }
 
 // static
@@ -12,11 +12,13 @@
 #include <vector>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_refptr.h"
 #include "base/optional.h"
 #include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 #include "url/gurl.h"
 
@@ -30,7 +32,9 @@ using brave_component_updater::BraveComponent;
 
 namespace brave_shields {
 
+class AdBlockEngineHandle;
 class AdBlockRegionalService;
+struct AdBlockRequest;
 
 // The AdBlock regional service manager, in charge of initializing and
 // managing regional AdBlock clients.
@@ -51,28 +55,44 @@ class AdBlockRegionalServiceManager {
                           bool* matching_exception_filter,
                           bool* cancel_request_explicitly,
                           std::string* mock_data_url);
+  bool ShouldStartRequest(const AdBlockRequest& request,
+                          bool* matching_exception_filter,
+                          bool* cancel_request_explicitly,
+                          std::string* mock_data_url);
   void EnableTag(const std::string& tag, bool enabled);
   void AddResources(const std::string& resources);
   void EnableFilterList(const std::string& uuid, bool enabled);
 
-  base::Optional<base::Value> UrlCosmeticResources(
+  base::Optional<CosmeticResources> UrlCosmeticResources(
           const std::string& url);
-  base::Optional<base::Value> HiddenClassIdSelectors(
+  std::vector<std::string> HiddenClassIdSelectors(
           const std::vector<std::string>& classes,
           const std::vector<std::string>& ids,
           const std::vector<std::string>& exceptions);
 
  private:
   friend class ::AdBlockServiceTest;
+  using EngineHandles =
+      base::RefCountedData<std::vector<scoped_refptr<AdBlockEngineHandle>>>;
+
   bool Init();
   void StartRegionalServices();
   void UpdateFilterListPrefs(const std::string& uuid, bool enabled);
+  // Rebuilds |engine_handles_| from |regional_services_|. Must be called with
+  // |regional_services_lock_| held whenever |regional_services_| changes.
+  void UpdateEngineHandlesLocked();
+  scoped_refptr<EngineHandles> GetEngineHandles() const;
 
   brave_component_updater::BraveComponent::Delegate* delegate_;  // NOT OWNED
   bool initialized_;
   base::Lock regional_services_lock_;
   std::map<std::string, std::unique_ptr<AdBlockRegionalService>>
       regional_services_;
+  // Immutable snapshot of the engines of |regional_services_|, which is what
+  // request matching and cosmetic queries read. Replaced, never modified, so
+  // |engine_handles_lock_| is only held to copy the pointer.
+  mutable base::Lock engine_handles_lock_;
+  scoped_refptr<EngineHandles> engine_handles_;
 
   DISALLOW_COPY_AND_ASSIGN(AdBlockRegionalServiceManager);
 };
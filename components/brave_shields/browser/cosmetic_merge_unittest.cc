@@ -4,7 +4,7 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "base/json/json_reader.h"
-#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -22,19 +22,19 @@ class CosmeticResourceMergeTest : public testing::Test {
           const std::string& b,
           bool force_hide,
           const std::string& expected) {
-    base::Optional<base::Value> a_val = base::JSONReader::Read(a);
+    base::Optional<CosmeticResources> a_val = CosmeticResources::FromJSON(a);
     ASSERT_TRUE(a_val);
 
-    base::Optional<base::Value> b_val = base::JSONReader::Read(b);
+    base::Optional<CosmeticResources> b_val = CosmeticResources::FromJSON(b);
     ASSERT_TRUE(b_val);
 
     const base::Optional<base::Value> expected_val =
         base::JSONReader::Read(expected);
     ASSERT_TRUE(expected_val);
 
-    MergeResourcesInto(&*a_val, &*b_val, force_hide);
+    a_val->MergeFrom(std::move(*b_val), force_hide);
 
-    ASSERT_EQ(*a_val, *expected_val);
+    ASSERT_EQ(a_val->ToValue(), *expected_val);
   }
 
  protected:
@@ -53,7 +53,7 @@ const char EMPTY_RESOURCES[] = "{"
 
 const char NONEMPTY_RESOURCES[] = "{"
     "\"hide_selectors\": [\"a\", \"b\"], "
-    "\"style_selectors\": {\"c\": \"color: #fff\", \"d\": \"color: #000\"}, "
+    "\"style_selectors\": {\"c\": [\"color: #fff\"], \"d\": [\"color: #000\"]}, "
     "\"exceptions\": [\"e\", \"f\"], "
     "\"injected_script\": \"console.log('g')\", "
     "\"generichide\": false"
@@ -63,14 +63,13 @@ TEST_F(CosmeticResourceMergeTest, MergeTwoEmptyResources) {
   const std::string a = EMPTY_RESOURCES;
   const std::string b = EMPTY_RESOURCES;
 
-  // Same as EMPTY_RESOURCES, but with an additional newline in the
-  // injected_script
   const std::string expected = "{"
       "\"hide_selectors\": [], "
       "\"style_selectors\": {}, "
       "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
-      "\"generichide\": false"
+      "\"injected_script\": \"\", "
+      "\"generichide\": false, "
+      "\"force_hide_selectors\": []"
   "}";
 
   CompareMergeFromStrings(a, b, false, expected);
@@ -80,14 +79,14 @@ TEST_F(CosmeticResourceMergeTest, MergeEmptyIntoNonEmpty) {
   const std::string a = NONEMPTY_RESOURCES;
   const std::string b = EMPTY_RESOURCES;
 
-  // Same as a, but with an additional newline at the end of the
-  // injected_script
   const std::string expected = "{"
       "\"hide_selectors\": [\"a\", \"b\"], "
-      "\"style_selectors\": {\"c\": \"color: #fff\", \"d\": \"color: #000\"}, "
+      "\"style_selectors\": {\"c\": [\"color: #fff\"], "
+          "\"d\": [\"color: #000\"]}, "
       "\"exceptions\": [\"e\", \"f\"], "
-      "\"injected_script\": \"console.log('g')\n\", "
-      "\"generichide\": false"
+      "\"injected_script\": \"console.log('g')\", "
+      "\"generichide\": false, "
+      "\"force_hide_selectors\": []"
   "}";
 
   CompareMergeFromStrings(a, b, false, expected);
@@ -97,14 +96,14 @@ TEST_F(CosmeticResourceMergeTest, MergeNonEmptyIntoEmpty) {
   const std::string a = EMPTY_RESOURCES;
   const std::string b = NONEMPTY_RESOURCES;
 
-  // Same as b, but with an additional newline at the beginning of the
-  // injected_script
   const std::string expected = "{"
       "\"hide_selectors\": [\"a\", \"b\"],"
-      "\"style_selectors\": {\"c\": \"color: #fff\", \"d\": \"color: #000\"}, "
+      "\"style_selectors\": {\"c\": [\"color: #fff\"], "
+          "\"d\": [\"color: #000\"]}, "
       "\"exceptions\": [\"e\", \"f\"], "
-      "\"injected_script\": \"\nconsole.log('g')\", "
-      "\"generichide\": false"
+      "\"injected_script\": \"console.log('g')\", "
+      "\"generichide\": false, "
+      "\"force_hide_selectors\": []"
   "}";
 
   CompareMergeFromStrings(a, b, false, expected);
@@ -114,7 +113,8 @@ TEST_F(CosmeticResourceMergeTest, MergeNonEmptyIntoNonEmpty) {
   const std::string a = NONEMPTY_RESOURCES;
   const std::string b = "{"
       "\"hide_selectors\": [\"h\", \"i\"], "
-      "\"style_selectors\": {\"j\": \"color: #eee\", \"k\": \"color: #111\"}, "
+      "\"style_selectors\": {\"j\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]}, "
       "\"exceptions\": [\"l\", \"m\"], "
       "\"injected_script\": \"console.log('n')\", "
       "\"generichide\": false"
@@ -123,16 +123,43 @@ TEST_F(CosmeticResourceMergeTest, MergeNonEmptyIntoNonEmpty) {
   const std::string expected = "{"
       "\"hide_selectors\": [\"a\", \"b\", \"h\", \"i\"], "
       "\"style_selectors\": {"
-          "\"c\": \"color: #fff\", "
-          "\"d\": \"color: #000\", "
-          "\"j\": \"color: #eee\", "
-          "\"k\": \"color: #111\""
+          "\"c\": [\"color: #fff\"], "
+          "\"d\": [\"color: #000\"], "
+          "\"j\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]"
       "}, "
       "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
       "\"injected_script\": \"console.log('g')\nconsole.log('n')\", "
+      "\"generichide\": false, "
+      "\"force_hide_selectors\": []"
+  "}";
+
+  CompareMergeFromStrings(a, b, false, expected);
+}
+
+TEST_F(CosmeticResourceMergeTest, MergeOverlappingResources) {
+  const std::string a = NONEMPTY_RESOURCES;
+  const std::string b = "{"
+      "\"hide_selectors\": [\"b\", \"h\", \"a\"], "
+      "\"style_selectors\": {\"c\": [\"color: #fff\", \"width: 0\"]}, "
+      "\"exceptions\": [\"f\", \"l\"], "
+      "\"injected_script\": \"\", "
       "\"generichide\": false"
   "}";
 
+  // Selectors, styles and exceptions already present are not repeated.
+  const std::string expected = "{"
+      "\"hide_selectors\": [\"a\", \"b\", \"h\"], "
+      "\"style_selectors\": {"
+          "\"c\": [\"color: #fff\", \"width: 0\"], "
+          "\"d\": [\"color: #000\"]"
+      "}, "
+      "\"exceptions\": [\"e\", \"f\", \"l\"], "
+      "\"injected_script\": \"console.log('g')\", "
+      "\"generichide\": false, "
+      "\"force_hide_selectors\": []"
+  "}";
+
   CompareMergeFromStrings(a, b, false, expected);
 }
 
@@ -140,13 +167,11 @@ TEST_F(CosmeticResourceMergeTest, MergeEmptyForceHide) {
   const std::string a = EMPTY_RESOURCES;
   const std::string b = EMPTY_RESOURCES;
 
-  // Same as EMPTY_RESOURCES, but with an additional newline in the
-  // injected_script and a new empty `force_hide_selectors` array
   const std::string expected = "{"
       "\"hide_selectors\": [], "
       "\"style_selectors\": {}, "
       "\"exceptions\": [], "
-      "\"injected_script\": \"\n\","
+      "\"injected_script\": \"\","
       "\"generichide\": false, "
       "\"force_hide_selectors\": []"
   "}";
@@ -158,7 +183,8 @@ TEST_F(CosmeticResourceMergeTest, MergeNonEmptyForceHide) {
   const std::string a = NONEMPTY_RESOURCES;
   const std::string b = "{"
       "\"hide_selectors\": [\"h\", \"i\"], "
-      "\"style_selectors\": {\"j\": \"color: #eee\", \"k\": \"color: #111\"}, "
+      "\"style_selectors\": {\"j\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]}, "
       "\"exceptions\": [\"l\", \"m\"], "
       "\"injected_script\": \"console.log('n')\", "
       "\"generichide\": false"
@@ -167,10 +193,10 @@ TEST_F(CosmeticResourceMergeTest, MergeNonEmptyForceHide) {
   const std::string expected = "{"
       "\"hide_selectors\": [\"a\", \"b\"], "
       "\"style_selectors\": {"
-          "\"c\": \"color: #fff\", "
-          "\"d\": \"color: #000\", "
-          "\"j\": \"color: #eee\", "
-          "\"k\": \"color: #111\""
+          "\"c\": [\"color: #fff\"], "
+          "\"d\": [\"color: #000\"], "
+          "\"j\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]"
       "}, "
       "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
       "\"injected_script\": \"console.log('g')\nconsole.log('n')\","
@@ -186,7 +212,7 @@ TEST_F(CosmeticResourceMergeTest, MergeNonGenerichideIntoGenerichide) {
       "\"hide_selectors\": [], "
       "\"style_selectors\": {}, "
       "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
+      "\"injected_script\": \"\", "
       "\"generichide\": true"
   "}";
   const std::string b = EMPTY_RESOURCES;
@@ -195,8 +221,9 @@ TEST_F(CosmeticResourceMergeTest, MergeNonGenerichideIntoGenerichide) {
       "\"hide_selectors\": [], "
       "\"style_selectors\": {}, "
       "\"exceptions\": [], "
-      "\"injected_script\": \"\n\n\", "
-      "\"generichide\": true"
+      "\"injected_script\": \"\", "
+      "\"generichide\": true, "
+      "\"force_hide_selectors\": []"
   "}";
 
   CompareMergeFromStrings(a, b, false, expected);
@@ -206,7 +233,8 @@ TEST_F(CosmeticResourceMergeTest, MergeGenerichideIntoNonGenerichide) {
   const std::string a = NONEMPTY_RESOURCES;
   const std::string b = "{"
       "\"hide_selectors\": [\"h\", \"i\"], "
-      "\"style_selectors\": {\"j\": \"color: #eee\", \"k\": \"color: #111\"}, "
+      "\"style_selectors\": {\"j\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]}, "
       "\"exceptions\": [\"l\", \"m\"], "
       "\"injected_script\": \"console.log('n')\", "
       "\"generichide\": true"
@@ -215,38 +243,35 @@ TEST_F(CosmeticResourceMergeTest, MergeGenerichideIntoNonGenerichide) {
   const std::string expected = "{"
       "\"hide_selectors\": [\"a\", \"b\", \"h\", \"i\"], "
       "\"style_selectors\": {"
-          "\"c\": \"color: #fff\", "
-          "\"d\": \"color: #000\", "
-          "\"j\": \"color: #eee\", "
-          "\"k\": \"color: #111\""
+          "\"c\": [\"color: #fff\"], "
+          "\"d\": [\"color: #000\"], "
+          "\"j\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]"
       "}, "
       "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
       "\"injected_script\": \"console.log('g')\nconsole.log('n')\", "
-      "\"generichide\": true"
+      "\"generichide\": true, "
+      "\"force_hide_selectors\": []"
   "}";
 
   CompareMergeFromStrings(a, b, false, expected);
 }
 
-TEST_F(CosmeticResourceMergeTest, MergeGenerichideIntoGenerichide) {
-  const std::string a = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\", "
-      "\"generichide\": true"
-  "}";
+TEST_F(CosmeticResourceMergeTest, InvalidResources) {
+  EXPECT_FALSE(CosmeticResources::FromJSON("[]"));
+  EXPECT_FALSE(CosmeticResources::FromJSON("not json"));
+}
 
-  const std::string expected = "{"
-      "\"hide_selectors\": [], "
-      "\"style_selectors\": {}, "
-      "\"exceptions\": [], "
-      "\"injected_script\": \"\n\", "
-      "\"generichide\": true"
-  "}";
+TEST_F(CosmeticResourceMergeTest, MergeSelectors) {
+  std::vector<std::string> selectors =
+      ParseCosmeticSelectors("[\"#a\", \".b\", \"#a\"]");
+  EXPECT_EQ(std::vector<std::string>({"#a", ".b", "#a"}), selectors);
 
-  CompareMergeFromStrings(a, a, false, expected);
+  std::vector<std::string> merged;
+  MergeCosmeticSelectors(&merged, std::move(selectors));
+  MergeCosmeticSelectors(&merged, ParseCosmeticSelectors("[\".b\", \"#c\"]"));
+  MergeCosmeticSelectors(&merged, ParseCosmeticSelectors("{}"));
+  EXPECT_EQ(std::vector<std::string>({"#a", ".b", "#c"}), merged);
 }
 
-
 }  // namespace brave_shields
@@ -0,0 +1,123 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_host_index.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace brave_shields {
+
+namespace {
+
+const char kWildcardSuffix[] = ".*";
+
+}  // namespace
+
+HTTPSEHostIndex::Node::Node() = default;
+HTTPSEHostIndex::Node::Node(Node&&) = default;
+HTTPSEHostIndex::Node::~Node() = default;
+
+HTTPSEHostIndex::HTTPSEHostIndex() {
+  Clear();
+}
+
+HTTPSEHostIndex::~HTTPSEHostIndex() = default;
+
+void HTTPSEHostIndex::Clear() {
+  nodes_.clear();
+  keys_.clear();
+  // Root node.
+  nodes_.emplace_back();
+}
+
+uint32_t HTTPSEHostIndex::GetOrAddChild(uint32_t node,
+                                        base::StringPiece label) {
+  auto it = nodes_[node].children.find(label);
+  if (it != nodes_[node].children.end()) {
+    return it->second;
+  }
+  uint32_t child = nodes_.size();
+  // Insert before growing |nodes_|, which may invalidate references into it.
+  nodes_[node].children.emplace(label.as_string(), child);
+  nodes_.emplace_back();
+  return child;
+}
+
+void HTTPSEHostIndex::AddKey(const std::string& key) {
+  base::StringPiece labels(key);
+  bool wildcard = false;
+  if (labels.ends_with(kWildcardSuffix)) {
+    wildcard = true;
+    labels.remove_suffix(sizeof(kWildcardSuffix) - 1);
+  }
+  if (labels.empty()) {
+    return;
+  }
+
+  uint32_t node = 0;
+  while (!labels.empty()) {
+    size_t dot = labels.find('.');
+    node = GetOrAddChild(node, labels.substr(0, dot));
+    if (dot == base::StringPiece::npos) {
+      break;
+    }
+    labels.remove_prefix(dot + 1);
+  }
+
+  uint32_t& slot =
+      wildcard ? nodes_[node].wildcard_key : nodes_[node].exact_key;
+  if (slot == kNoKey) {
+    slot = keys_.size();
+    keys_.push_back(key);
+  }
+}
+
+void HTTPSEHostIndex::FindKeys(base::StringPiece host,
+                               std::vector<const std::string*>* keys) const {
+  keys->clear();
+  if (host.ends_with(".")) {
+    host.remove_suffix(1);
+  }
+  const size_t label_count = std::count(host.begin(), host.end(), '.') + 1;
+  if (label_count < 2) {
+    return;
+  }
+
+  // Walk from the top level domain towards the full host; wildcard matches
+  // are collected least specific first and reversed at the end.
+  uint32_t node = 0;
+  size_t depth = 0;
+  base::StringPiece remaining(host);
+  while (depth < label_count) {
+    size_t dot = remaining.rfind('.');
+    base::StringPiece label = dot == base::StringPiece::npos
+                                  ? remaining
+                                  : remaining.substr(dot + 1);
+    auto it = nodes_[node].children.find(label);
+    if (it == nodes_[node].children.end()) {
+      break;
+    }
+    node = it->second;
+    ++depth;
+
+    const Node& current = nodes_[node];
+    if (depth == label_count) {
+      if (current.exact_key != kNoKey) {
+        keys->push_back(&keys_[current.exact_key]);
+      }
+    } else if (depth >= 2 && current.wildcard_key != kNoKey) {
+      keys->push_back(&keys_[current.wildcard_key]);
+    }
+
+    if (dot == base::StringPiece::npos) {
+      break;
+    }
+    remaining = remaining.substr(0, dot);
+  }
+  std::reverse(keys->begin(), keys->end());
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_HOST_INDEX_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_HOST_INDEX_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace brave_shields {
+
+// In-memory reversed-label trie over the keys of the HTTPS Everywhere
+// database. Keys look like "com.example.www" for an exact host or
+// "com.example.*" for every subdomain of example.com. A host is resolved to
+// its candidate keys with a single walk and no string building.
+class HTTPSEHostIndex {
+ public:
+  HTTPSEHostIndex();
+  ~HTTPSEHostIndex();
+
+  void AddKey(const std::string& key);
+  void Clear();
+  bool empty() const { return keys_.empty(); }
+  size_t size() const { return keys_.size(); }
+
+  // Fills |keys| with the database keys which may hold a ruleset for |host|,
+  // most specific first: the exact host, then wildcards for each parent
+  // domain down to (but excluding) the top level domain.
+  void FindKeys(base::StringPiece host,
+                std::vector<const std::string*>* keys) const;
+
+ private:
+  static constexpr uint32_t kNoKey = UINT32_MAX;
+
+  struct Node {
+    Node();
+    Node(Node&&);
+    ~Node();
+
+    std::map<std::string, uint32_t, std::less<>> children;
+    uint32_t exact_key = kNoKey;
+    uint32_t wildcard_key = kNoKey;
+  };
+
+  uint32_t GetOrAddChild(uint32_t node, base::StringPiece label);
+
+  std::vector<Node> nodes_;
+  std::vector<std::string> keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSEHostIndex);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_HOST_INDEX_H_
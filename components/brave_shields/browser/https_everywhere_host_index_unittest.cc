@@ -0,0 +1,61 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+#include <vector>
+
+#include "brave/components/brave_shields/browser/https_everywhere_host_index.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+std::vector<std::string> FindKeys(const brave_shields::HTTPSEHostIndex& index,
+                                  const std::string& host) {
+  std::vector<const std::string*> keys;
+  index.FindKeys(host, &keys);
+  std::vector<std::string> result;
+  for (const std::string* key : keys)
+    result.push_back(*key);
+  return result;
+}
+
+}  // namespace
+
+TEST(HTTPSEHostIndexTest, MatchesLegacyLookupOrder) {
+  brave_shields::HTTPSEHostIndex index;
+  index.AddKey("com.example.a.b");
+  index.AddKey("com.example.a.*");
+  index.AddKey("com.example.*");
+  index.AddKey("com.*");
+  index.AddKey("com.example.a.b.*");
+  EXPECT_EQ(index.size(), 5u);
+
+  // Exact host first, then parent wildcards, never the TLD wildcard and never
+  // a wildcard on the host itself.
+  EXPECT_EQ(FindKeys(index, "b.a.example.com"),
+            (std::vector<std::string>{"com.example.a.b", "com.example.a.*",
+                                      "com.example.*"}));
+  EXPECT_EQ(FindKeys(index, "c.a.example.com"),
+            (std::vector<std::string>{"com.example.a.*", "com.example.*"}));
+  EXPECT_EQ(FindKeys(index, "example.com"), std::vector<std::string>());
+  EXPECT_EQ(FindKeys(index, "x.example.com"),
+            std::vector<std::string>{"com.example.*"});
+  EXPECT_EQ(FindKeys(index, "example.org"), std::vector<std::string>());
+  EXPECT_EQ(FindKeys(index, "com"), std::vector<std::string>());
+}
+
+TEST(HTTPSEHostIndexTest, ExactKeys) {
+  brave_shields::HTTPSEHostIndex index;
+  index.AddKey("org.example");
+  EXPECT_EQ(FindKeys(index, "example.org"),
+            std::vector<std::string>{"org.example"});
+  EXPECT_EQ(FindKeys(index, "example.org."),
+            std::vector<std::string>{"org.example"});
+  EXPECT_EQ(FindKeys(index, "www.example.org"), std::vector<std::string>());
+
+  index.Clear();
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(FindKeys(index, "example.org"), std::vector<std::string>());
+}
@@ -6,24 +6,39 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "base/containers/mru_cache.h"
 #include "base/synchronization/lock.h"
 
-template <class T> class HTTPSERecentlyUsedCache {
+// Thread safe MRU cache. Entries are spread over |kShardCount| independently
+// locked shards so that lookups from different threads rarely contend; each
+// shard evicts its own least recently used entry once it holds
+// |size| / |kShardCount| entries.
+template <class T, size_t kShardCount = 1> class HTTPSERecentlyUsedCache {
  public:
-  explicit HTTPSERecentlyUsedCache(size_t size = 100) : data_(size) {}
+  explicit HTTPSERecentlyUsedCache(size_t size = 100) {
+    for (size_t i = 0; i < kShardCount; ++i) {
+      shards_.push_back(
+          std::make_unique<Shard>(std::max<size_t>(1, size / kShardCount)));
+    }
+  }
 
   void add(const std::string& key, const T& value) {
-    base::AutoLock create(lock_);
-    data_.Put(key, value);
+    Shard& shard = GetShard(key);
+    base::AutoLock create(shard.lock);
+    shard.data.Put(key, value);
   }
 
   bool get(const std::string& key, T* value) {
-    base::AutoLock create(lock_);
-    auto it = data_.Get(key);
-    if (it != data_.end()) {
+    Shard& shard = GetShard(key);
+    base::AutoLock create(shard.lock);
+    auto it = shard.data.Get(key);
+    if (it != shard.data.end()) {
       *value = it->second;
       return true;
     }
@@ -31,15 +46,35 @@ template <class T> class HTTPSERecentlyUsedCache {
   }
 
   void remove(const std::string& key) {
-    base::AutoLock lock(lock_);
-    auto it = data_.Peek(key);
-    if (it != data_.end())
-      data_.Erase(it);
+    Shard& shard = GetShard(key);
+    base::AutoLock lock(shard.lock);
+    auto it = shard.data.Peek(key);
+    if (it != shard.data.end())
+      shard.data.Erase(it);
+  }
+
+  void clear() {
+    for (auto& shard : shards_) {
+      base::AutoLock lock(shard->lock);
+      shard->data.Clear();
+    }
   }
 
  private:
-  base::MRUCache<std::string, T> data_;
-  base::Lock lock_;
+  struct Shard {
+    explicit Shard(size_t size) : data(size) {}
+
+    base::MRUCache<std::string, T> data;
+    base::Lock lock;
+  };
+
+  Shard& GetShard(const std::string& key) {
+    if (kShardCount == 1)
+      return *shards_[0];
+    return *shards_[std::hash<std::string>()(key) % kShardCount];
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
 };
 
 #endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
@@ -28,3 +28,25 @@ TEST(HTTPSEverywhereRecentlyUsedCacheTest, Operations) {
   cache.remove("kD");
   ASSERT_FALSE(cache.get("kD", &v));
 }
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, ShardedOperations) {
+  using Cache = HTTPSERecentlyUsedCache<std::string, 4>;
+  Cache cache(400);
+
+  for (int i = 0; i < 50; ++i)
+    cache.add("k" + std::to_string(i), "v" + std::to_string(i));
+  std::string v;
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_TRUE(cache.get("k" + std::to_string(i), &v));
+    ASSERT_EQ(v, "v" + std::to_string(i));
+  }
+
+  // Empty values are stored like any other value.
+  cache.add("kNegative", "");
+  ASSERT_TRUE(cache.get("kNegative", &v));
+  ASSERT_TRUE(v.empty());
+
+  cache.clear();
+  ASSERT_FALSE(cache.get("k0", &v));
+  ASSERT_FALSE(cache.get("kNegative", &v));
+}
@@ -0,0 +1,44 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECT_COUNTER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECT_COUNTER_H_
+
+#include <stdint.h>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+
+namespace brave_shields {
+
+// Counts the HTTPS Everywhere redirects applied to each in-flight request so
+// that redirect loops between http and https can be broken. Entries are
+// removed when the request is destroyed; the table is also bounded, dropping
+// the least recently redirected request when full. All methods are thread
+// safe and O(1).
+class HTTPSERedirectCounter {
+ public:
+  HTTPSERedirectCounter(size_t max_requests, unsigned int max_redirects);
+  ~HTTPSERedirectCounter();
+
+  // Returns false once |request_identifier| reached the redirect limit.
+  bool ShouldRedirect(uint64_t request_identifier);
+  void AddRedirect(uint64_t request_identifier);
+  void RemoveRequest(uint64_t request_identifier);
+
+  size_t size();
+
+ private:
+  const unsigned int max_redirects_;
+  base::Lock lock_;
+  base::HashingMRUCache<uint64_t, unsigned int> redirects_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERedirectCounter);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECT_COUNTER_H_
@@ -0,0 +1,55 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_redirect_counter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::HTTPSERedirectCounter;
+
+TEST(HTTPSERedirectCounterTest, StopsAtLimit) {
+  HTTPSERedirectCounter counter(10, 4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(counter.ShouldRedirect(1));
+    counter.AddRedirect(1);
+  }
+  EXPECT_FALSE(counter.ShouldRedirect(1));
+  EXPECT_TRUE(counter.ShouldRedirect(2));
+
+  counter.RemoveRequest(1);
+  EXPECT_TRUE(counter.ShouldRedirect(1));
+  EXPECT_EQ(counter.size(), 0u);
+}
+
+TEST(HTTPSERedirectCounterTest, InterleavedRequests) {
+  // With a single tracked slot, interleaving requests used to reset every
+  // count and so never detected a loop.
+  const uint64_t kRequests = 200;
+  HTTPSERedirectCounter counter(kRequests, 4);
+  for (int round = 0; round < 4; ++round) {
+    for (uint64_t id = 1; id <= kRequests; ++id) {
+      ASSERT_TRUE(counter.ShouldRedirect(id));
+      counter.AddRedirect(id);
+    }
+  }
+  for (uint64_t id = 1; id <= kRequests; ++id)
+    EXPECT_FALSE(counter.ShouldRedirect(id));
+  EXPECT_EQ(counter.size(), kRequests);
+
+  for (uint64_t id = 1; id <= kRequests; ++id)
+    counter.RemoveRequest(id);
+  EXPECT_EQ(counter.size(), 0u);
+}
+
+TEST(HTTPSERedirectCounterTest, Bounded) {
+  HTTPSERedirectCounter counter(2, 1);
+  counter.AddRedirect(1);
+  counter.AddRedirect(2);
+  counter.AddRedirect(3);
+  EXPECT_EQ(counter.size(), 2u);
+  // The least recently redirected request was evicted.
+  EXPECT_TRUE(counter.ShouldRedirect(1));
+  EXPECT_FALSE(counter.ShouldRedirect(2));
+  EXPECT_FALSE(counter.ShouldRedirect(3));
+}
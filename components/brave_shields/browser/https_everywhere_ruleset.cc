@@ -0,0 +1,131 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/memory/ptr_util.h"
+#include "base/values.h"
+#include "third_party/re2/src/re2/re2.h"
+
+namespace brave_shields {
+
+HTTPSERuleset::Rule::Rule() = default;
+HTTPSERuleset::Rule::Rule(Rule&&) = default;
+HTTPSERuleset::Rule::~Rule() = default;
+
+HTTPSERuleset::Target::Target() = default;
+HTTPSERuleset::Target::Target(Target&&) = default;
+HTTPSERuleset::Target::~Target() = default;
+
+HTTPSERuleset::HTTPSERuleset() = default;
+HTTPSERuleset::~HTTPSERuleset() = default;
+
+// static
+std::unique_ptr<HTTPSERuleset> HTTPSERuleset::Parse(const std::string& json) {
+  base::Optional<base::Value> json_object = base::JSONReader::Read(json);
+  if (base::nullopt == json_object || !json_object->is_list()) {
+    return nullptr;
+  }
+
+  auto ruleset = base::WrapUnique(new HTTPSERuleset());
+  for (const auto& top_value : json_object->GetList()) {
+    if (!top_value.is_dict()) {
+      continue;
+    }
+
+    Target target;
+    const base::Value* exclusions = top_value.FindListKey("e");
+    if (exclusions) {
+      for (const auto& exclusion : exclusions->GetList()) {
+        if (!exclusion.is_dict()) {
+          continue;
+        }
+        const std::string* pattern = exclusion.FindStringKey("p");
+        if (!pattern) {
+          continue;
+        }
+        auto regexp =
+            std::make_unique<re2::RE2>(CorrectToRuleToRE2Engine(*pattern));
+        if (regexp->ok()) {
+          target.exclusions.push_back(std::move(regexp));
+        }
+      }
+    }
+
+    const base::Value* rules = top_value.FindListKey("r");
+    if (rules) {
+      target.has_rules = true;
+      for (const auto& rule_value : rules->GetList()) {
+        if (!rule_value.is_dict()) {
+          continue;
+        }
+        Rule rule;
+        if (rule_value.FindKey("d")) {
+          rule.is_default = true;
+          target.rules.push_back(std::move(rule));
+          continue;
+        }
+        const std::string* from = rule_value.FindStringKey("f");
+        const std::string* to = rule_value.FindStringKey("t");
+        if (!from || !to) {
+          continue;
+        }
+        rule.from = std::make_unique<re2::RE2>(*from);
+        if (!rule.from->ok()) {
+          continue;
+        }
+        rule.to = CorrectToRuleToRE2Engine(*to);
+        target.rules.push_back(std::move(rule));
+      }
+    }
+    ruleset->targets_.push_back(std::move(target));
+  }
+
+  return ruleset;
+}
+
+std::string HTTPSERuleset::Apply(const std::string& original_url) const {
+  for (const auto& target : targets_) {
+    for (const auto& exclusion : target.exclusions) {
+      if (re2::RE2::FullMatch(original_url, *exclusion)) {
+        return "";
+      }
+    }
+
+    if (!target.has_rules) {
+      return "";
+    }
+
+    for (const auto& rule : target.rules) {
+      if (rule.is_default) {
+        std::string new_url(original_url);
+        return new_url.insert(4, "s");
+      }
+
+      std::string new_url(original_url);
+      if (re2::RE2::Replace(&new_url, *rule.from, rule.to) &&
+          new_url != original_url) {
+        return new_url;
+      }
+    }
+  }
+  return "";
+}
+
+// static
+std::string HTTPSERuleset::CorrectToRuleToRE2Engine(const std::string& to) {
+  std::string corrected_to(to);
+  size_t pos = corrected_to.find('$');
+  while (std::string::npos != pos) {
+    corrected_to[pos] = '\\';
+    pos = corrected_to.find('$', pos + 1);
+  }
+  return corrected_to;
+}
+
+}  // namespace brave_shields
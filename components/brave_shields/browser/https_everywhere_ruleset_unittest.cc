@@ -0,0 +1,62 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::HTTPSERuleset;
+
+TEST(HTTPSERulesetTest, RejectsMalformedJSON) {
+  EXPECT_FALSE(HTTPSERuleset::Parse(""));
+  EXPECT_FALSE(HTTPSERuleset::Parse("{}"));
+  EXPECT_FALSE(HTTPSERuleset::Parse("[{"));
+}
+
+TEST(HTTPSERulesetTest, DefaultRule) {
+  auto ruleset = HTTPSERuleset::Parse("[{\"r\":[{\"d\":1}]}]");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ(ruleset->Apply("http://example.com/"), "https://example.com/");
+}
+
+TEST(HTTPSERulesetTest, FromToRule) {
+  auto ruleset = HTTPSERuleset::Parse(
+      "[{\"r\":[{\"f\":\"^http://(www\\\\.)?example\\\\.com/\","
+      "\"t\":\"https://www.example.com/\"}]}]");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ(ruleset->Apply("http://example.com/a"),
+            "https://www.example.com/a");
+  EXPECT_EQ(ruleset->Apply("http://other.com/a"), "");
+  // Applying again reuses the compiled programs.
+  EXPECT_EQ(ruleset->Apply("http://www.example.com/b"),
+            "https://www.example.com/b");
+}
+
+TEST(HTTPSERulesetTest, BackReferences) {
+  auto ruleset = HTTPSERuleset::Parse(
+      "[{\"r\":[{\"f\":\"^http://(\\\\w+)\\\\.example\\\\.com/\","
+      "\"t\":\"https://$1.example.com/\"}]}]");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ(ruleset->Apply("http://img.example.com/x.png"),
+            "https://img.example.com/x.png");
+  EXPECT_EQ(HTTPSERuleset::CorrectToRuleToRE2Engine("$1/$2"), "\\1/\\2");
+}
+
+TEST(HTTPSERulesetTest, Exclusions) {
+  auto ruleset = HTTPSERuleset::Parse(
+      "[{\"e\":[{\"p\":\"^http://example\\\\.com/plain/.*\"}],"
+      "\"r\":[{\"d\":1}]}]");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ(ruleset->Apply("http://example.com/plain/page"), "");
+  EXPECT_EQ(ruleset->Apply("http://example.com/secure"),
+            "https://example.com/secure");
+}
+
+TEST(HTTPSERulesetTest, TargetWithoutRulesStopsLookup) {
+  auto ruleset = HTTPSERuleset::Parse("[{},{\"r\":[{\"d\":1}]}]");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ(ruleset->Apply("http://example.com/"), "");
+}
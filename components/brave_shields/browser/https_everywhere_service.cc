@@ -12,59 +12,45 @@
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/json/json_reader.h"
+#include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
-#include "base/values.h"
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
 #define DAT_FILE_VERSION "6.0"
-#define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1
+#define DAT_FILE_UNZIPPED_MARKER "httpse.leveldb.unzipped"
+#define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1000
 #define HTTPSE_URL_MAX_REDIRECTS_COUNT      5
+#define HTTPSE_RULESETS_CACHE_SIZE          1000
+#define HTTPSE_RECENTLY_USED_CACHE_SIZE     1024
 
 namespace {
 
-std::vector<std::string> Split(const std::string& s, char delim) {
-  std::stringstream ss(s);
-  std::string item;
-  std::vector<std::string> result;
-  while (getline(ss, item, delim)) {
-    result.push_back(item);
+// Values of the Brave.HTTPSE.RecentlyUsedCache histogram. These are logged
+// to UMA, so entries must not be renumbered.
+enum class CacheLookupResult {
+  kHitRedirect = 0,
+  kHitNoRedirect = 1,
+  kMiss = 2,
+  kMaxValue = kMiss,
+};
+
+void RecordCacheLookup(bool hit, const std::string& cached_url) {
+  CacheLookupResult result = CacheLookupResult::kMiss;
+  if (hit) {
+    result = cached_url.empty() ? CacheLookupResult::kHitNoRedirect
+                                : CacheLookupResult::kHitRedirect;
   }
-  return result;
+  UMA_HISTOGRAM_ENUMERATION("Brave.HTTPSE.RecentlyUsedCache", result);
 }
 
-// returns parts in reverse order, makes list of lookup domains like com.foo.*
-std::vector<std::string> ExpandDomainForLookup(const std::string& domain) {
-  std::vector<std::string> resultDomains;
-  std::vector<std::string> domainParts = Split(domain, '.');
-  if (domainParts.empty()) {
-    return resultDomains;
-  }
-
-  for (size_t i = 0; i < domainParts.size() - 1; i++) {
-    // i < size()-1 is correct: don't want 'com.*' added to resultDomains
-    std::string slice = "";
-    std::string dot = "";
-    for (int j = domainParts.size() - 1; j >= static_cast<int>(i); j--) {
-      slice += dot + domainParts[j];
-      dot = ".";
-    }
-    if (0 != i) {
-      // We don't want * on the top URL
-      resultDomains.push_back(slice + ".*");
-    } else {
-      resultDomains.push_back(slice);
-    }
-  }
-  return resultDomains;
-}
 std::string leveldbGet(leveldb::DB* db, const std::string &key) {
   if (!db) {
     return "";
@@ -100,6 +86,10 @@ HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
 HTTPSEverywhereService::HTTPSEverywhereService(
     BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
+      redirect_counter_(HTTPSE_URLS_REDIRECTS_COUNT_QUEUE,
+                        HTTPSE_URL_MAX_REDIRECTS_COUNT - 1),
+      recently_used_cache_(HTTPSE_RECENTLY_USED_CACHE_SIZE),
+      rulesets_(HTTPSE_RULESETS_CACHE_SIZE),
       level_db_(nullptr) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
@@ -128,13 +118,25 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
       install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FILE);
   base::FilePath unzipped_level_db_path = zip_db_file_path.RemoveExtension();
   base::FilePath destination = zip_db_file_path.DirName();
-  if (!zip::Unzip(zip_db_file_path, destination)) {
-    LOG(ERROR) << "Failed to unzip database file "
-               << zip_db_file_path.value().c_str();
-    return;
+  // Component install directories are versioned, so the database only has to
+  // be extracted the first time a given version is loaded.
+  base::FilePath unzipped_marker_path =
+      destination.AppendASCII(DAT_FILE_UNZIPPED_MARKER);
+  if (!base::PathExists(unzipped_marker_path)) {
+    if (!zip::Unzip(zip_db_file_path, destination)) {
+      LOG(ERROR) << "Failed to unzip database file "
+                 << zip_db_file_path.value().c_str();
+      return;
+    }
+    if (base::WriteFile(unzipped_marker_path, "", 0) != 0) {
+      LOG(ERROR) << "Failed to write "
+                 << unzipped_marker_path.value().c_str();
+    }
   }
 
   CloseDatabase();
+  // Cached results, including the negative ones, belong to the old rules.
+  recently_used_cache_.clear();
 
   leveldb::Options options;
   leveldb::Status status =
@@ -147,8 +149,23 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
                << unzipped_level_db_path.value().c_str()
                << ", error: " << status.ToString();
     CloseDatabase();
+    // A partial or corrupt extraction would otherwise never be retried.
+    base::DeleteFile(unzipped_marker_path, false);
     return;
   }
+
+  std::unique_ptr<leveldb::Iterator> it(
+      level_db_->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    host_index_.AddKey(it->key().ToString());
+  }
+  if (!it->status().ok()) {
+    LOG(ERROR) << "Level db iteration error "
+               << unzipped_level_db_path.value().c_str()
+               << ", error: " << it->status().ToString();
+    CloseDatabase();
+    base::DeleteFile(unzipped_marker_path, false);
+  }
 }
 
 void HTTPSEverywhereService::OnComponentReady(
@@ -179,6 +196,9 @@ bool HTTPSEverywhereService::GetHTTPSURL(
   }
 
   if (recently_used_cache_.get(url->spec(), new_url)) {
+    if (new_url->empty()) {
+      return false;
+    }
     AddHTTPSEUrlToRedirectList(request_identifier);
     return true;
   }
@@ -190,12 +210,12 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     candidate_url = candidate_url.ReplaceComponents(replacements);
   }
 
-  const std::vector<std::string> domains =
-      ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      *new_url = ApplyHTTPSRule(candidate_url.spec(), value);
+  std::vector<const std::string*> keys;
+  host_index_.FindKeys(candidate_url.host_piece(), &keys);
+  for (const std::string* key : keys) {
+    const HTTPSERuleset* ruleset = GetRuleset(*key);
+    if (ruleset) {
+      *new_url = ruleset->Apply(candidate_url.spec());
       if (0 != new_url->length()) {
         recently_used_cache_.add(candidate_url.spec(), *new_url);
         AddHTTPSEUrlToRedirectList(request_identifier);
@@ -203,7 +223,8 @@ bool HTTPSEverywhereService::GetHTTPSURL(
       }
     }
   }
-  recently_used_cache_.remove(candidate_url.spec());
+  new_url->clear();
+  recently_used_cache_.add(candidate_url.spec(), std::string());
   return false;
 }
 
@@ -221,169 +242,52 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
     return false;
   }
 
-  if (recently_used_cache_.get(url->spec(), cached_url)) {
+  bool hit = recently_used_cache_.get(url->spec(), cached_url);
+  RecordCacheLookup(hit, *cached_url);
+  if (!hit) {
+    return false;
+  }
+  if (!cached_url->empty()) {
     AddHTTPSEUrlToRedirectList(request_identifier);
-    return true;
   }
-  return false;
+  return true;
 }
 
 bool HTTPSEverywhereService::ShouldHTTPSERedirect(
     const uint64_t& request_identifier) {
-  base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
-  for (size_t i = 0; i < httpse_urls_redirects_count_.size(); i++) {
-    if (request_identifier ==
-        httpse_urls_redirects_count_[i].request_identifier_ &&
-        httpse_urls_redirects_count_[i].redirects_ >=
-        HTTPSE_URL_MAX_REDIRECTS_COUNT - 1) {
-      return false;
-    }
-  }
-
-  return true;
+  return redirect_counter_.ShouldRedirect(request_identifier);
 }
 
 void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
     const uint64_t& request_identifier) {
-  // Adding redirects count for the current request
-  base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
-  bool hostFound = false;
-  for (size_t i = 0; i < httpse_urls_redirects_count_.size(); i++) {
-    if (request_identifier ==
-        httpse_urls_redirects_count_[i].request_identifier_) {
-      // Found the host, just increment the redirects_count
-      httpse_urls_redirects_count_[i].redirects_++;
-      hostFound = true;
-      break;
-    }
-  }
-  if (!hostFound) {
-      // The host is new, adding it to the redirects list
-      if (httpse_urls_redirects_count_.size() >=
-          HTTPSE_URLS_REDIRECTS_COUNT_QUEUE) {
-          // The queue is full, erase the first element
-          httpse_urls_redirects_count_.erase(
-              httpse_urls_redirects_count_.begin());
-      }
-      httpse_urls_redirects_count_.push_back(
-          HTTPSE_REDIRECTS_COUNT_ST(request_identifier, 1));
-  }
+  redirect_counter_.AddRedirect(request_identifier);
 }
 
-std::string HTTPSEverywhereService::ApplyHTTPSRule(
-    const std::string& originalUrl,
-    const std::string& rule) {
-  base::Optional<base::Value> json_object = base::JSONReader::Read(rule);
-  if (base::nullopt == json_object || !json_object->is_list()) {
-    return "";
-  }
-
-  base::Value::ConstListView topValues = json_object->GetList();
-  for (auto it = topValues.cbegin(); it != topValues.cend(); ++it) {
-    if (!it->is_dict()) {
-      continue;
-    }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    it->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
-    }
-
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
-
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
-    }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
-
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
-    }
-  }
-  return "";
+void HTTPSEverywhereService::OnRequestDestroyed(
+    const uint64_t& request_identifier) {
+  redirect_counter_.RemoveRequest(request_identifier);
 }
 
-std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
-    const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
+const HTTPSERuleset* HTTPSEverywhereService::GetRuleset(
+    const std::string& key) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = rulesets_.Get(key);
+  if (it != rulesets_.end()) {
+    return it->second.get();
   }
 
-  return correctedto;
+  std::string value = leveldbGet(level_db_, key);
+  std::unique_ptr<HTTPSERuleset> ruleset;
+  if (!value.empty()) {
+    ruleset = HTTPSERuleset::Parse(value);
+  }
+  return rulesets_.Put(key, std::move(ruleset))->second.get();
 }
 
 void HTTPSEverywhereService::CloseDatabase() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  rulesets_.Clear();
+  host_index_.Clear();
   if (level_db_) {
     delete level_db_;
     level_db_ = nullptr;
@@ -10,12 +10,14 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
-#include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
+#include "brave/components/brave_shields/browser/https_everywhere_host_index.h"
 #include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
+#include "brave/components/brave_shields/browser/https_everywhere_redirect_counter.h"
 
 namespace leveldb {
 class DB;
@@ -27,22 +29,12 @@ using brave_component_updater::BraveComponent;
 
 namespace brave_shields {
 
+class HTTPSERuleset;
+
 extern const char kHTTPSEverywhereComponentName[];
 extern const char kHTTPSEverywhereComponentId[];
 extern const char kHTTPSEverywhereComponentBase64PublicKey[];
 
-struct HTTPSE_REDIRECTS_COUNT_ST {
- public:
-  HTTPSE_REDIRECTS_COUNT_ST(uint64_t request_identifier,
-                            unsigned int redirects):
-    request_identifier_(request_identifier),
-    redirects_(redirects) {
-  }
-
-  uint64_t request_identifier_;
-  unsigned int redirects_;
-};
-
 class HTTPSEverywhereService : public BaseBraveShieldsService,
                          public base::SupportsWeakPtr<HTTPSEverywhereService> {
  public:
@@ -51,9 +43,14 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
   bool GetHTTPSURL(const GURL* url,
                    const uint64_t& request_id,
                    std::string* new_url);
+  // Returns true if the cache holds a result for |url|. |cached_url| is left
+  // empty when the URL is known not to have an HTTPS rewrite.
   bool GetHTTPSURLFromCacheOnly(const GURL* url,
                                 const uint64_t& request_id,
                                 std::string* cached_url);
+  // Drops the redirect count kept for |request_id|. Called when the request
+  // goes away; safe to call from any thread.
+  void OnRequestDestroyed(const uint64_t& request_id);
 
  protected:
   bool Init() override;
@@ -64,9 +61,9 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
 
   void AddHTTPSEUrlToRedirectList(const uint64_t& request_id);
   bool ShouldHTTPSERedirect(const uint64_t& request_id);
-  std::string ApplyHTTPSRule(const std::string& originalUrl,
-      const std::string& rule);
-  std::string CorrecttoRuleToRE2Engine(const std::string& to);
+  // Returns the compiled ruleset stored under |key|, loading and compiling it
+  // on first use. Returns nullptr if there is no valid ruleset for |key|.
+  const HTTPSERuleset* GetRuleset(const std::string& key);
 
  private:
   friend class ::HTTPSEverywhereServiceTest;
@@ -82,9 +79,16 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
 
   void InitDB(const base::FilePath& install_dir);
 
-  base::Lock httpse_get_urls_redirects_count_mutex_;
-  std::vector<HTTPSE_REDIRECTS_COUNT_ST> httpse_urls_redirects_count_;
-  HTTPSERecentlyUsedCache<std::string> recently_used_cache_;
+  HTTPSERedirectCounter redirect_counter_;
+  // Maps a URL spec to its rewritten URL, or to an empty string when no rule
+  // applies. Read from the IO-side callers as well, hence the sharding.
+  HTTPSERecentlyUsedCache<std::string, 16> recently_used_cache_;
+  // Compiled rulesets keyed by their LevelDB key. Missing or malformed
+  // rulesets are cached as nullptr so they are not looked up again.
+  base::MRUCache<std::string, std::unique_ptr<HTTPSERuleset>> rulesets_;
+  // Keys of |level_db_|, used to find the rulesets for a host without
+  // probing the database for every parent domain.
+  HTTPSEHostIndex host_index_;
   leveldb::DB* level_db_;
 
   SEQUENCE_CHECKER(sequence_checker_);
@@ -0,0 +1,95 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/content_settings/core/common/content_settings_rule_index.h"
+
+#include <algorithm>
+
+#include "base/strings/string_piece.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+#include "url/gurl.h"
+
+namespace content_settings {
+
+ContentSettingsRuleIndex::ContentSettingsRuleIndex() = default;
+
+ContentSettingsRuleIndex::ContentSettingsRuleIndex(
+    const ContentSettingsForOneType& rules)
+    : rules_(rules) {
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    const ContentSettingsPattern& pattern = rules_[i].primary_pattern;
+    const std::string host = pattern.GetHost();
+    if (host.empty() || pattern.MatchesAllHosts()) {
+      any_host_.push_back(i);
+    } else if (pattern.HasDomainWildcard()) {
+      domains_[host].push_back(i);
+    } else {
+      hosts_[host].push_back(i);
+    }
+  }
+}
+
+ContentSettingsRuleIndex::~ContentSettingsRuleIndex() = default;
+
+std::vector<size_t> ContentSettingsRuleIndex::GetCandidates(
+    const GURL& primary_url) const {
+  // Patterns match filesystem: URLs by their inner URL, and ignore a trailing
+  // dot on the host.
+  const GURL& url = primary_url.SchemeIsFileSystem() && primary_url.inner_url()
+                        ? *primary_url.inner_url()
+                        : primary_url;
+  base::StringPiece host = url.host_piece();
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+
+  std::vector<size_t> candidates(any_host_);
+  auto it = hosts_.find(host);
+  if (it != hosts_.end())
+    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+
+  // A domain wildcard also matches the domain itself, so probe the host and
+  // each of its parent domains.
+  if (!domains_.empty()) {
+    while (!host.empty()) {
+      it = domains_.find(host);
+      if (it != domains_.end()) {
+        candidates.insert(candidates.end(), it->second.begin(),
+                          it->second.end());
+      }
+      size_t dot = host.find('.');
+      if (dot == base::StringPiece::npos)
+        break;
+      host.remove_prefix(dot + 1);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  return candidates;
+}
+
+std::vector<const ContentSettingPatternSource*>
+ContentSettingsRuleIndex::GetPrimaryMatches(const GURL& primary_url) const {
+  std::vector<const ContentSettingPatternSource*> matches;
+  for (size_t index : GetCandidates(primary_url)) {
+    if (rules_[index].primary_pattern.Matches(primary_url))
+      matches.push_back(&rules_[index]);
+  }
+  return matches;
+}
+
+const ContentSettingPatternSource* ContentSettingsRuleIndex::FindFirstMatch(
+    const GURL& primary_url,
+    const GURL& secondary_url) const {
+  for (size_t index : GetCandidates(primary_url)) {
+    const ContentSettingPatternSource& rule = rules_[index];
+    if (rule.primary_pattern.Matches(primary_url) &&
+        rule.secondary_pattern.Matches(secondary_url)) {
+      return &rule;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace content_settings
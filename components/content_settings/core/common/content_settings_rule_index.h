@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_COMMON_CONTENT_SETTINGS_RULE_INDEX_H_
+#define BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_COMMON_CONTENT_SETTINGS_RULE_INDEX_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/macros.h"
+#include "components/content_settings/core/common/content_settings.h"
+
+class GURL;
+
+namespace content_settings {
+
+// A list of content setting rules grouped by the host of each rule's primary
+// pattern. A lookup only runs ContentSettingsPattern::Matches on the rules
+// which could apply to the primary URL's host, and still reports matches in
+// the precedence order of the original list.
+class ContentSettingsRuleIndex {
+ public:
+  ContentSettingsRuleIndex();
+  explicit ContentSettingsRuleIndex(const ContentSettingsForOneType& rules);
+  ~ContentSettingsRuleIndex();
+
+  // Returns the rules whose primary pattern matches |primary_url|, in list
+  // order.
+  std::vector<const ContentSettingPatternSource*> GetPrimaryMatches(
+      const GURL& primary_url) const;
+
+  // Returns the first rule whose patterns match both URLs, or null.
+  const ContentSettingPatternSource* FindFirstMatch(
+      const GURL& primary_url,
+      const GURL& secondary_url) const;
+
+  size_t size() const { return rules_.size(); }
+
+ private:
+  using HostMap =
+      base::flat_map<std::string, std::vector<size_t>, std::less<>>;
+
+  // Returns the positions of the rules filed under the host of
+  // |primary_url|, in ascending order.
+  std::vector<size_t> GetCandidates(const GURL& primary_url) const;
+
+  const ContentSettingsForOneType rules_;
+  // Rules for an exact host, e.g. "https://brave.com".
+  HostMap hosts_;
+  // Rules for a domain and its subdomains, e.g. "[*.]brave.com", keyed by
+  // "brave.com".
+  HostMap domains_;
+  // Rules matching every host, including the wildcard default.
+  std::vector<size_t> any_host_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingsRuleIndex);
+};
+
+}  // namespace content_settings
+
+#endif  // BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_COMMON_CONTENT_SETTINGS_RULE_INDEX_H_
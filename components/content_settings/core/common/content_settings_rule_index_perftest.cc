@@ -0,0 +1,129 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/content_settings/core/common/content_settings_rule_index.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+#include "components/content_settings/core/common/content_settings_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_unit_tests \
+//     --filter=ContentSettingsRuleIndexPerfTest.* --run-manual
+
+using content_settings::ContentSettingsRuleIndex;
+
+namespace {
+
+const int kRuleCount = 10000;
+// Sites looked up, a tenth of which have no rule of their own
+const int kLookupCount = 1000;
+
+const char kMetricPrefixContentSettingsRuleIndex[] =
+    "ContentSettingsRuleIndex.";
+const char kMetricIndexedLookupTime[] = "indexed_lookup_time";
+const char kMetricLinearLookupTime[] = "linear_lookup_time";
+
+ContentSettingPatternSource MakeRule(const std::string& primary,
+                                     ContentSetting setting) {
+  return ContentSettingPatternSource(
+      ContentSettingsPattern::FromString(primary),
+      ContentSettingsPattern::Wildcard(),
+      base::Value::FromUniquePtrValue(
+          content_settings::ContentSettingToValue(setting)),
+      std::string(), false);
+}
+
+// What the shields lookups did before the index: the first rule of the list
+// whose patterns match both URLs
+const ContentSettingPatternSource* FindFirstMatchLinear(
+    const ContentSettingsForOneType& rules,
+    const GURL& primary_url,
+    const GURL& secondary_url) {
+  for (const auto& rule : rules) {
+    if (rule.primary_pattern.Matches(primary_url) &&
+        rule.secondary_pattern.Matches(secondary_url)) {
+      return &rule;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+// Time of one lookup in a list with a rule per site, as in a profile with
+// thousands of per-site shields settings, with the index and with a linear
+// scan of the same list.
+TEST(ContentSettingsRuleIndexPerfTest, MANUAL_IndexedVsLinearLookup) {
+  ContentSettingsForOneType rules;
+  for (int i = 0; i < kRuleCount; ++i) {
+    rules.push_back(MakeRule(base::StringPrintf("[*.]site%d.com", i),
+                             i % 2 ? CONTENT_SETTING_BLOCK
+                                   : CONTENT_SETTING_ALLOW));
+  }
+  rules.push_back(MakeRule("*", CONTENT_SETTING_ASK));
+  const ContentSettingsRuleIndex index(rules);
+
+  // Spread over the list, so the linear scan does not stop early on average
+  std::vector<GURL> primary_urls;
+  for (int i = 0; i < kLookupCount; ++i) {
+    primary_urls.emplace_back(
+        i % 10 ? base::StringPrintf("https://www.site%d.com/",
+                                    i * (kRuleCount / kLookupCount))
+               : base::StringPrintf("https://unknown%d.com/", i));
+  }
+  const GURL secondary_url("https://cdn.example.com/");
+
+  // The index keeps its own copy of the rules, so compare what they say
+  for (const GURL& url : primary_urls) {
+    const ContentSettingPatternSource* indexed =
+        index.FindFirstMatch(url, secondary_url);
+    const ContentSettingPatternSource* linear =
+        FindFirstMatchLinear(rules, url, secondary_url);
+    ASSERT_TRUE(indexed && linear) << url.spec();
+    EXPECT_EQ(indexed->primary_pattern, linear->primary_pattern);
+    EXPECT_EQ(indexed->GetContentSetting(), linear->GetContentSetting());
+  }
+
+  perf_test::PerfResultReporter reporter(
+      kMetricPrefixContentSettingsRuleIndex,
+      base::StringPrintf("%d_rules", kRuleCount));
+  reporter.RegisterImportantMetric(kMetricIndexedLookupTime, "us");
+  reporter.RegisterImportantMetric(kMetricLinearLookupTime, "us");
+
+  size_t matches = 0;
+  base::LapTimer indexed_timer;
+  do {
+    for (const GURL& url : primary_urls) {
+      matches += index.FindFirstMatch(url, secondary_url) != nullptr;
+    }
+    indexed_timer.NextLap();
+  } while (!indexed_timer.HasTimeLimitExpired());
+  reporter.AddResult(
+      kMetricIndexedLookupTime,
+      indexed_timer.TimePerLap() / primary_urls.size());
+
+  base::LapTimer linear_timer;
+  do {
+    for (const GURL& url : primary_urls) {
+      matches +=
+          FindFirstMatchLinear(rules, url, secondary_url) != nullptr;
+    }
+    linear_timer.NextLap();
+  } while (!linear_timer.HasTimeLimitExpired());
+  reporter.AddResult(
+      kMetricLinearLookupTime,
+      linear_timer.TimePerLap() / primary_urls.size());
+
+  // Keeps the lookups from being optimized away
+  EXPECT_GT(matches, 0u);
+}
@@ -0,0 +1,98 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/content_settings/core/common/content_settings_rule_index.h"
+
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+#include "components/content_settings/core/common/content_settings_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using content_settings::ContentSettingsRuleIndex;
+
+namespace {
+
+ContentSettingPatternSource MakeRule(const std::string& primary,
+                                     const std::string& secondary,
+                                     ContentSetting setting) {
+  return ContentSettingPatternSource(
+      ContentSettingsPattern::FromString(primary),
+      ContentSettingsPattern::FromString(secondary),
+      base::Value::FromUniquePtrValue(
+          content_settings::ContentSettingToValue(setting)),
+      std::string(), false);
+}
+
+ContentSetting FindSetting(const ContentSettingsRuleIndex& index,
+                           const std::string& primary_url,
+                           const std::string& secondary_url) {
+  const ContentSettingPatternSource* rule =
+      index.FindFirstMatch(GURL(primary_url), GURL(secondary_url));
+  return rule ? rule->GetContentSetting() : CONTENT_SETTING_DEFAULT;
+}
+
+}  // namespace
+
+TEST(ContentSettingsRuleIndexTest, MatchesInPrecedenceOrder) {
+  ContentSettingsForOneType rules;
+  rules.push_back(
+      MakeRule("https://www.brave.com:443", "*", CONTENT_SETTING_ALLOW));
+  rules.push_back(MakeRule("[*.]brave.com", "*", CONTENT_SETTING_BLOCK));
+  rules.push_back(
+      MakeRule("[*.]example.com", "https://cdn.net", CONTENT_SETTING_BLOCK));
+  rules.push_back(MakeRule("*", "*", CONTENT_SETTING_ASK));
+  ContentSettingsRuleIndex index(rules);
+
+  EXPECT_EQ(CONTENT_SETTING_ALLOW,
+            FindSetting(index, "https://www.brave.com/", "https://a.com/"));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            FindSetting(index, "http://www.brave.com/", "https://a.com/"));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            FindSetting(index, "https://brave.com/", "https://a.com/"));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            FindSetting(index, "https://a.b.brave.com./", "https://a.com/"));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            FindSetting(index, "https://sub.example.com/", "https://cdn.net/"));
+  EXPECT_EQ(CONTENT_SETTING_ASK,
+            FindSetting(index, "https://sub.example.com/", "https://a.com/"));
+  EXPECT_EQ(CONTENT_SETTING_ASK,
+            FindSetting(index, "https://notbrave.com/", "https://a.com/"));
+
+  ContentSettingsRuleIndex empty_index;
+  EXPECT_EQ(CONTENT_SETTING_DEFAULT,
+            FindSetting(empty_index, "https://brave.com/", "https://a.com/"));
+
+  auto matches = index.GetPrimaryMatches(GURL("https://www.brave.com/"));
+  ASSERT_EQ(3u, matches.size());
+  EXPECT_EQ(CONTENT_SETTING_ALLOW, matches[0]->GetContentSetting());
+  EXPECT_EQ(CONTENT_SETTING_BLOCK, matches[1]->GetContentSetting());
+  EXPECT_EQ(ContentSettingsPattern::Wildcard(), matches[2]->primary_pattern);
+}
+
+TEST(ContentSettingsRuleIndexTest, ManyRules) {
+  // One exception per site, as in a profile with thousands of per-site shields
+  // settings. Lookups must still find the right site's rule.
+  const int kRuleCount = 10000;
+  ContentSettingsForOneType rules;
+  for (int i = 0; i < kRuleCount; ++i) {
+    rules.push_back(MakeRule(base::StringPrintf("[*.]site%d.com", i), "*",
+                             i % 2 ? CONTENT_SETTING_BLOCK
+                                   : CONTENT_SETTING_ALLOW));
+  }
+  rules.push_back(MakeRule("*", "*", CONTENT_SETTING_ASK));
+  ContentSettingsRuleIndex index(rules);
+  EXPECT_EQ(static_cast<size_t>(kRuleCount + 1), index.size());
+
+  for (int i = 0; i < kRuleCount; i += 997) {
+    const std::string url = base::StringPrintf("https://www.site%d.com/", i);
+    EXPECT_EQ(i % 2 ? CONTENT_SETTING_BLOCK : CONTENT_SETTING_ALLOW,
+              FindSetting(index, url, "https://a.com/"));
+  }
+  EXPECT_EQ(CONTENT_SETTING_ASK,
+            FindSetting(index, "https://unknown.com/", "https://a.com/"));
+}
@@ -12,12 +12,14 @@
 
 #include "base/bind_helpers.h"
 #include "base/feature_list.h"
+#include "base/no_destructor.h"
 #include "base/stl_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/common/render_messages.h"
 #include "brave/common/shield_exceptions.h"
 #include "brave/components/brave_shields/common/brave_shield_utils.h"
 #include "brave/components/brave_shields/common/features.h"
+#include "brave/components/content_settings/core/common/content_settings_rule_index.h"
 #include "brave/content/common/frame_messages.h"
 #include "components/content_settings/core/common/content_settings_pattern.h"
 #include "components/content_settings/core/common/content_settings_utils.h"
@@ -37,6 +39,10 @@
 namespace content_settings {
 namespace {
 
+// Bumped whenever new content setting rules arrive. Rules are only updated and
+// read on the render thread.
+uint64_t g_content_setting_rules_version = 0;
+
 GURL GetOriginOrURL(
     const blink::WebFrame* frame) {
   url::Origin top_origin = url::Origin(frame->Top()->GetSecurityOrigin());
@@ -50,21 +56,40 @@ GURL GetOriginOrURL(
   return top_origin.GetURL();
 }
 
-bool IsBraveShieldsDown(const blink::WebFrame* frame,
-                        const GURL& secondary_url,
-                        const ContentSettingsForOneType& rules) {
-  ContentSetting setting = CONTENT_SETTING_DEFAULT;
-  const GURL& primary_url = GetOriginOrURL(frame);
-
-  for (const auto& rule : rules) {
-    if (rule.primary_pattern.Matches(primary_url) &&
-        rule.secondary_pattern.Matches(secondary_url)) {
-      setting = rule.GetContentSetting();
-      break;
-    }
+// The Brave rule lists of a RendererContentSettingRules, indexed by host.
+// Every frame in the renderer points at the same rules, so the indexes are
+// built once per rules update and shared by all agents.
+struct CompiledContentSettingRules {
+  explicit CompiledContentSettingRules(
+      const RendererContentSettingRules& rules)
+      : source(&rules),
+        version(g_content_setting_rules_version),
+        brave_shields_rules(rules.brave_shields_rules),
+        autoplay_rules(rules.autoplay_rules) {}
+
+  const RendererContentSettingRules* const source;
+  const uint64_t version;
+  const ContentSettingsRuleIndex brave_shields_rules;
+  const ContentSettingsRuleIndex autoplay_rules;
+};
+
+const CompiledContentSettingRules& GetCompiledContentSettingRules(
+    const RendererContentSettingRules& rules) {
+  static base::NoDestructor<std::unique_ptr<CompiledContentSettingRules>>
+      compiled;
+  if (!*compiled || (*compiled)->source != &rules ||
+      (*compiled)->version != g_content_setting_rules_version) {
+    *compiled = std::make_unique<CompiledContentSettingRules>(rules);
   }
+  return **compiled;
+}
 
-  return setting == CONTENT_SETTING_BLOCK;
+bool IsBraveShieldsDown(const blink::WebFrame* frame,
+                        const GURL& secondary_url,
+                        const ContentSettingsRuleIndex& rules) {
+  const ContentSettingPatternSource* rule =
+      rules.FindFirstMatch(GetOriginOrURL(frame), secondary_url);
+  return rule && rule->GetContentSetting() == CONTENT_SETTING_BLOCK;
 }
 
 }  // namespace
@@ -80,6 +105,11 @@ BraveContentSettingsAgentImpl::BraveContentSettingsAgentImpl(
 BraveContentSettingsAgentImpl::~BraveContentSettingsAgentImpl() {
 }
 
+// static
+void BraveContentSettingsAgentImpl::OnContentSettingRulesChanged() {
+  ++g_content_setting_rules_version;
+}
+
 bool BraveContentSettingsAgentImpl::OnMessageReceived(
     const IPC::Message& message) {
   bool handled = true;
@@ -102,6 +132,7 @@ void BraveContentSettingsAgentImpl::DidCommitProvisionalLoad(
   if (!is_same_document_navigation) {
     temporarily_allowed_scripts_ =
       std::move(preloaded_temporarily_allowed_scripts_);
+    farbling_level_.reset();
   }
 
   ContentSettingsAgentImpl::DidCommitProvisionalLoad(
@@ -186,7 +217,9 @@ bool BraveContentSettingsAgentImpl::IsBraveShieldsDown(
     const GURL& secondary_url) {
   return !content_setting_rules_ ||
          ::content_settings::IsBraveShieldsDown(
-             frame, secondary_url, content_setting_rules_->brave_shields_rules);
+             frame, secondary_url,
+             GetCompiledContentSettingRules(*content_setting_rules_)
+                 .brave_shields_rules);
 }
 
 bool BraveContentSettingsAgentImpl::AllowFingerprinting(
@@ -208,6 +241,17 @@ bool BraveContentSettingsAgentImpl::AllowFingerprinting(
 }
 
 BraveFarblingLevel BraveContentSettingsAgentImpl::GetBraveFarblingLevel() {
+  if (!content_setting_rules_)
+    return ComputeBraveFarblingLevel();
+  if (!farbling_level_ ||
+      farbling_level_rules_version_ != g_content_setting_rules_version) {
+    farbling_level_ = ComputeBraveFarblingLevel();
+    farbling_level_rules_version_ = g_content_setting_rules_version;
+  }
+  return *farbling_level_;
+}
+
+BraveFarblingLevel BraveContentSettingsAgentImpl::ComputeBraveFarblingLevel() {
   blink::WebLocalFrame* frame = render_frame()->GetWebFrame();
 
   ContentSetting setting = CONTENT_SETTING_DEFAULT;
@@ -249,19 +293,20 @@ bool BraveContentSettingsAgentImpl::AllowAutoplay(bool default_value) {
   const GURL& primary_url = GetOriginOrURL(frame);
   const GURL& secondary_url =
       url::Origin(frame->GetDocument().GetSecurityOrigin()).GetURL();
-  for (const auto& rule : content_setting_rules_->autoplay_rules) {
-    if (rule.primary_pattern == ContentSettingsPattern::Wildcard())
+  const ContentSettingsRuleIndex& autoplay_rules =
+      GetCompiledContentSettingRules(*content_setting_rules_).autoplay_rules;
+  for (const auto* rule : autoplay_rules.GetPrimaryMatches(primary_url)) {
+    if (rule->primary_pattern == ContentSettingsPattern::Wildcard())
         continue;
-    if (rule.primary_pattern.Matches(primary_url) &&
-        (rule.secondary_pattern == ContentSettingsPattern::Wildcard() ||
-         rule.secondary_pattern.Matches(secondary_url))) {
-      if (rule.GetContentSetting() == CONTENT_SETTING_BLOCK) {
+    if (rule->secondary_pattern == ContentSettingsPattern::Wildcard() ||
+        rule->secondary_pattern.Matches(secondary_url)) {
+      if (rule->GetContentSetting() == CONTENT_SETTING_BLOCK) {
         VLOG(1) << "AllowAutoplay=false because rule=CONTENT_SETTING_BLOCK";
         return false;
-      } else if (rule.GetContentSetting() == CONTENT_SETTING_ASK) {
+      } else if (rule->GetContentSetting() == CONTENT_SETTING_ASK) {
         VLOG(1) << "AllowAutoplay=ask because rule=CONTENT_SETTING_ASK";
         ask = true;
-      } else if (rule.GetContentSetting() == CONTENT_SETTING_ALLOW) {
+      } else if (rule->GetContentSetting() == CONTENT_SETTING_ALLOW) {
         VLOG(1) << "AllowAutoplay=true because rule=CONTENT_SETTING_ALLOW";
         return true;
       }
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "base/optional.h"
 #include "base/strings/string16.h"
 #include "brave/third_party/blink/renderer/brave_farbling_constants.h"
 #include "components/content_settings/core/common/content_settings.h"
@@ -30,6 +31,10 @@ class BraveContentSettingsAgentImpl : public ContentSettingsAgentImpl {
                                 std::unique_ptr<Delegate> delegate);
   ~BraveContentSettingsAgentImpl() override;
 
+  // Called when the browser sends this renderer new content setting rules.
+  // Drops the decisions every frame has cached from the old rules.
+  static void OnContentSettingRulesChanged();
+
  protected:
   bool AllowScript(bool enabled_per_settings) override;
   bool AllowScriptFromSource(bool enabled_per_settings,
@@ -58,6 +63,8 @@ class BraveContentSettingsAgentImpl : public ContentSettingsAgentImpl {
 
   bool IsScriptTemporilyAllowed(const GURL& script_url);
 
+  BraveFarblingLevel ComputeBraveFarblingLevel();
+
   // Origins of scripts which are temporary allowed for this frame in the
   // current load
   base::flat_set<std::string> temporarily_allowed_scripts_;
@@ -68,6 +75,13 @@ class BraveContentSettingsAgentImpl : public ContentSettingsAgentImpl {
   // temporary allowed script origins we preloaded for the next load
   base::flat_set<std::string> preloaded_temporarily_allowed_scripts_;
 
+  // Farbling level of the current document, and the version of the content
+  // setting rules it was computed from. Fingerprinting scripts query it in
+  // tight loops, so the rules are only matched again after a new commit or
+  // a rules update.
+  base::Optional<BraveFarblingLevel> farbling_level_;
+  uint64_t farbling_level_rules_version_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(BraveContentSettingsAgentImpl);
 };
 
@@ -0,0 +1,43 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_THIRD_PARTY_BLINK_RENDERER_BRAVE_AUDIO_FARBLING_HELPERS_H_
+#define BRAVE_THIRD_PARTY_BLINK_RENDERER_BRAVE_AUDIO_FARBLING_HELPERS_H_
+
+#include <stdint.h>
+
+#include "base/containers/span.h"
+
+namespace brave {
+
+// Next value of the 64-bit LFSR that seeds every pseudo-random farbling.
+inline uint64_t LfsrNext(uint64_t v) {
+  const uint64_t zero = 0;
+  return ((v >> 1) | (((v << 62) ^ (v << 61)) & (~(~zero << 63) << 62)));
+}
+
+// Scales every sample by |fudge_factor|. The loop body makes no calls so that
+// the compiler can vectorize it.
+inline void MultiplyAudioSamples(base::span<float> samples,
+                                 float fudge_factor) {
+  for (float& sample : samples)
+    sample *= fudge_factor;
+}
+
+// Overwrites the samples with a pseudo-random sequence between 0 and 0.1
+// that starts from |seed|.
+inline void FillPseudoRandomAudioSamples(base::span<float> samples,
+                                         uint64_t seed) {
+  const double maxUInt64AsDouble = UINT64_MAX;
+  uint64_t v = seed;
+  for (float& sample : samples) {
+    v = LfsrNext(v);
+    sample = (v / maxUInt64AsDouble) / 10;
+  }
+}
+
+}  // namespace brave
+
+#endif  // BRAVE_THIRD_PARTY_BLINK_RENDERER_BRAVE_AUDIO_FARBLING_HELPERS_H_
@@ -0,0 +1,125 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/third_party/blink/renderer/brave_audio_farbling_helpers.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+// npm run test -- brave_unit_tests --filter=AudioFarblingPerfTest.* \
+//     --run-manual
+
+namespace {
+
+// One second of one channel at 48 kHz
+const size_t kSampleCount = 48000;
+const float kFudgeFactor = 0.99999f;
+const uint64_t kSeed = 0x0123456789abcdefULL;
+
+const char kMetricPrefixAudioFarbling[] = "AudioFarbling.";
+const char kMetricCallbackTime[] = "callback_time";
+const char kMetricSpanTime[] = "span_time";
+
+using AudioFarblingCallback = base::RepeatingCallback<float(float, size_t)>;
+
+// The per-sample callbacks BALANCED and MAXIMUM ran before whole channels
+// were farbled at once
+float ConstantMultiplier(double fudge_factor, float value, size_t index) {
+  return value * fudge_factor;
+}
+
+float PseudoRandomSequence(uint64_t seed,
+                           uint64_t* state,
+                           float value,
+                           size_t index) {
+  const double maxUInt64AsDouble = UINT64_MAX;
+  if (index == 0)
+    *state = seed;
+  *state = brave::LfsrNext(*state);
+  return (*state / maxUInt64AsDouble) / 10;
+}
+
+void FarbleWithCallback(const AudioFarblingCallback& callback,
+                        std::vector<float>* samples) {
+  for (size_t i = 0; i < samples->size(); i++)
+    (*samples)[i] = callback.Run((*samples)[i], i);
+}
+
+std::vector<float> CreateSamples() {
+  std::vector<float> samples(kSampleCount);
+  for (size_t i = 0; i < samples.size(); i++)
+    samples[i] = static_cast<float>(i % 200) / 100 - 1;
+  return samples;
+}
+
+// Reports the time to farble one channel with the per-sample callback and
+// with the span helper, after checking both give the same samples.
+void MeasureFarbling(const std::string& story,
+                     const AudioFarblingCallback& callback,
+                     const base::RepeatingCallback<void(base::span<float>)>&
+                         farble_span) {
+  std::vector<float> expected = CreateSamples();
+  FarbleWithCallback(callback, &expected);
+  std::vector<float> actual = CreateSamples();
+  farble_span.Run(actual);
+  for (size_t i = 0; i < kSampleCount; i++)
+    ASSERT_FLOAT_EQ(expected[i], actual[i]) << i;
+
+  perf_test::PerfResultReporter reporter(kMetricPrefixAudioFarbling, story);
+  reporter.RegisterImportantMetric(kMetricCallbackTime, "us");
+  reporter.RegisterImportantMetric(kMetricSpanTime, "us");
+
+  // Farbling the same buffer over and over keeps its values in range, and
+  // the sum keeps the loops from being optimized away
+  std::vector<float> samples = CreateSamples();
+  double sum = 0;
+
+  base::LapTimer callback_timer;
+  do {
+    FarbleWithCallback(callback, &samples);
+    sum += samples[kSampleCount - 1];
+    callback_timer.NextLap();
+  } while (!callback_timer.HasTimeLimitExpired());
+  reporter.AddResult(kMetricCallbackTime, callback_timer.TimePerLap());
+
+  samples = CreateSamples();
+  base::LapTimer span_timer;
+  do {
+    farble_span.Run(samples);
+    sum += samples[kSampleCount - 1];
+    span_timer.NextLap();
+  } while (!span_timer.HasTimeLimitExpired());
+  reporter.AddResult(kMetricSpanTime, span_timer.TimePerLap());
+
+  EXPECT_NE(sum, 0);
+}
+
+}  // namespace
+
+// Time to farble one channel of getChannelData or copyFromChannel at the
+// BALANCED and MAXIMUM levels.
+TEST(AudioFarblingPerfTest, MANUAL_CallbackVsSpan) {
+  MeasureFarbling(
+      "balanced",
+      base::BindRepeating(&ConstantMultiplier, kFudgeFactor),
+      base::BindRepeating([](base::span<float> samples) {
+        brave::MultiplyAudioSamples(samples, kFudgeFactor);
+      }));
+
+  MeasureFarbling(
+      "maximum",
+      base::BindRepeating(&PseudoRandomSequence, kSeed,
+                          base::Owned(new uint64_t(0))),
+      base::BindRepeating([](base::span<float> samples) {
+        brave::FillPseudoRandomAudioSamples(samples, kSeed);
+      }));
+}